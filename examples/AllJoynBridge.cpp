@@ -30,6 +30,12 @@
 #include <stdlib.h>
 
 static volatile sig_atomic_t sQuitFlag = false;
+/*
+ * The stack dispatches CoAP requests and responses from its own threads; OCProcess() is only
+ * needed for housekeeping (presence, observe and retransmission timeouts).  This also bounds
+ * how long a SIGINT may go unnoticed.
+ */
+static const uint32_t sProcessPeriodMs = 100;
 static const char *gPSPrefix = "AllJoynBridge_";
 static const char *sUUID = NULL;
 static const char *sSender = NULL;
@@ -39,6 +45,11 @@ static bool sSecureMode = true;
 #else
 static bool sSecureMode = false;
 #endif
+static size_t sMaxHandshakes = 0; /* 0 uses the bridge default */
+static size_t sProbeWindow = 0; /* 0 uses the bridge default */
+static uint32_t sPropertyMaxAgeMs = 0;
+static uint32_t sNotifyWindowMs = 0;
+static uint32_t sNotifyMaxLatencyMs = 0;
 
 static void SigIntCB(int sig)
 {
@@ -220,6 +231,26 @@ int main(int argc, char **argv)
                     sSecureMode = true;
                 }
             }
+            else if (!strcmp(argv[i], "--maxHandshakes") && (i < (argc - 1)))
+            {
+                sMaxHandshakes = strtoul(argv[++i], NULL, 0);
+            }
+            else if (!strcmp(argv[i], "--probeWindow") && (i < (argc - 1)))
+            {
+                sProbeWindow = strtoul(argv[++i], NULL, 0);
+            }
+            else if (!strcmp(argv[i], "--propertyMaxAge") && (i < (argc - 1)))
+            {
+                sPropertyMaxAgeMs = strtoul(argv[++i], NULL, 0);
+            }
+            else if (!strcmp(argv[i], "--notifyWindow") && (i < (argc - 1)))
+            {
+                sNotifyWindowMs = strtoul(argv[++i], NULL, 0);
+            }
+            else if (!strcmp(argv[i], "--notifyMaxLatency") && (i < (argc - 1)))
+            {
+                sNotifyMaxLatencyMs = strtoul(argv[++i], NULL, 0);
+            }
         }
     }
     /* uuid, sender, and rd must be supplied together and when they are, aj and oc are ignored */
@@ -319,6 +350,16 @@ int main(int argc, char **argv)
         bridge->SetProcessCB(ExecCB, KillCB, GetSeenStateCB);
     }
     bridge->SetSecureMode(sSecureMode);
+    if (sMaxHandshakes)
+    {
+        bridge->SetMaxHandshakes(sMaxHandshakes);
+    }
+    if (sProbeWindow)
+    {
+        bridge->SetProbeWindow(sProbeWindow);
+    }
+    bridge->SetPropertyMaxAge(sPropertyMaxAgeMs);
+    bridge->SetNotifyCoalescing(sNotifyWindowMs, sNotifyMaxLatencyMs);
     if (!bridge->Start())
     {
         goto exit;
@@ -335,11 +376,7 @@ int main(int argc, char **argv)
             fprintf(stderr, "OCProcess - %d\n", result);
             goto exit;
         }
-#ifdef _WIN32
-        Sleep(1);
-#else
-        usleep(1 * 1000);
-#endif
+        bridge->Wait(sProcessPeriodMs);
     }
     ret = EXIT_SUCCESS;
 
@@ -27,18 +27,20 @@
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/SessionListener.h>
 #include <inttypes.h>
-#include <list>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <vector>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 class AllJoynSecurity;
+class Executor;
+class IntrospectionCache;
 class OCSecurity;
-class Presence;
-class VirtualBusAttachment;
-class VirtualBusObject;
-class VirtualDevice;
+class Registry;
+class TaskQueue;
 class VirtualResource;
 
 class Bridge : private ajn::AboutListener
@@ -68,48 +70,56 @@ class Bridge : private ajn::AboutListener
         void SetSessionLostCB(SessionLostCB cb) { m_sessionLostCb = cb; }
         void SetSecureMode(bool secureMode) { m_secureMode = secureMode; }
 
+        struct HandshakeStats
+        {
+            size_t m_queued; /* Handshakes waiting for a worker */
+            size_t m_active; /* Handshakes in progress */
+            uint64_t m_completed;
+            uint64_t m_failed;
+            uint64_t m_totalQueuedMs; /* Time spent waiting for a worker */
+            uint64_t m_totalHandshakeMs; /* Time spent in SecureConnection() */
+            uint64_t m_maxHandshakeMs;
+        };
+        /* Limits the number of concurrent secure connection handshakes, the minimum is 1. */
+        void SetMaxHandshakes(size_t maxHandshakes);
+        HandshakeStats GetHandshakeStats();
+        /* Limits the number of concurrent GETs used to infer the definitions of a device without
+         * an introspection resource, the minimum is 1. */
+        void SetProbeWindow(size_t window);
+        /* Bounds the age of cached AllJoyn property values used to answer GETs of properties that
+         * do not emit a changed signal, 0 (the default) fetches them on every GET. */
+        void SetPropertyMaxAge(uint32_t maxAgeMs);
+        /* Coalesces the property changes of AllJoyn devices into fewer notifications to OC
+         * observers, see VirtualResource::SetNotifyCoalescing().  A windowMs of 0 (the default)
+         * notifies observers of every change. */
+        void SetNotifyCoalescing(uint32_t windowMs, uint32_t maxLatencyMs);
+
         bool Start();
         bool Stop();
         bool Process();
+        /* Blocks until Process() has work to do or timeoutMs elapses, whichever is first. */
+        void Wait(uint32_t timeoutMs);
 
         /* Used internally */
         void RDPublish();
+        /* Calls VirtualResource::FlushNotifications() of the resource at path of id at tick. */
+        void ScheduleNotify(const char *id, const char *path, uint64_t tick);
 
     private:
         struct DiscoverContext;
-        struct Task
-        {
-            time_t m_tick;
-            Task(time_t tick) : m_tick(tick) { }
-            virtual ~Task() { }
-            virtual void Run(Bridge *thiz) = 0;
-        };
-        struct AnnouncedTask : public Task {
-            std::string m_name;
-            std::string m_piid;
-            bool m_isVirtual;
-            AnnouncedTask(time_t tick, const char *name, const char *piid, bool isVirtual)
-                : Task(tick), m_name(name), m_piid(piid), m_isVirtual(isVirtual) { }
-            virtual ~AnnouncedTask() { }
-            virtual void Run(Bridge *thiz);
-        };
-        struct DiscoverTask : public Task {
-            std::string m_piid;
-            OCRepPayload *m_payload;
-            DiscoverContext *m_context;
-            DiscoverTask(time_t tick, const char *piid, OCRepPayload *payload,
-                    DiscoverContext *context) : Task(tick), m_piid(piid),
-                    m_payload(OCRepPayloadClone(payload)), m_context(context) { }
-            virtual ~DiscoverTask() { OCRepPayloadDestroy(m_payload); }
-            virtual void Run(Bridge *thiz);
-        };
-        struct RDPublishTask : public Task {
-            RDPublishTask(time_t tick) : Task(tick) { }
-            virtual ~RDPublishTask() { }
-            virtual void Run(Bridge *thiz);
-        };
+        struct DiscoverWork;
+        struct Task;
+        struct AnnouncedTask;
+        struct DiscoverTask;
+        struct RDPublishTask;
+        struct SaveCacheTask;
+        struct NotifyTask;
+        struct Handshake;
 
-        static const time_t DISCOVER_PERIOD_SECS = 5;
+        static const time_t DISCOVER_PERIOD_SECS = 5; /* Used while devices come and go */
+        static const time_t DISCOVER_PERIOD_MAX_SECS = 80; /* Backed off to while stable */
+        static const size_t MAX_HANDSHAKES_DEFAULT = 4;
+        static const size_t PROBE_WINDOW_DEFAULT = 8;
 
         ExecCB m_execCb;
         GetSeenStateCB m_seenStateCb;
@@ -118,6 +128,8 @@ class Bridge : private ajn::AboutListener
 
         std::mutex m_mutex;
         std::condition_variable m_cond;
+        std::condition_variable m_wakeCond;
+        bool m_wake;
         Protocol m_protocols;
         enum { CREATED, STARTED, CONNECTED, CLAIMABLE, RUNNING } m_ajState;
         const char *m_sender;
@@ -125,18 +137,47 @@ class Bridge : private ajn::AboutListener
         AllJoynSecurity *m_ajSecurity;
         OCSecurity *m_ocSecurity;
         OCDoHandle m_discoverHandle;
-        time_t m_discoverNextTick;
-        std::vector<Presence *> m_presence;
-        std::vector<VirtualDevice *> m_virtualDevices;
-        std::vector<VirtualResource *> m_virtualResources;
-        std::vector<VirtualBusAttachment *> m_virtualBusAttachments;
+        uint64_t m_discoverNextTick;
+        uint64_t m_discoverPeriodMs;
+        bool m_discoverChurn; /* A device appeared, changed, or disappeared this period */
+        struct ResObserve
+        {
+            OCDoHandle m_handle;
+            bool m_registered; /* The registration reply has been received */
+        };
+        std::map<std::string, ResObserve> m_resObserves; /* di => observation of its /oic/res */
+        struct DeviceFingerprint
+        {
+            uint64_t m_resources; /* Of the resources and types of the device */
+            std::vector<uint64_t> m_replies; /* Of the replies seen with those resources */
+        };
+        /* Fingerprints of replies that need no further processing */
+        std::unordered_set<uint64_t> m_fingerprints;
+        std::unordered_map<std::string, DeviceFingerprint> m_deviceFingerprints; /* di => */
+        Registry *m_registry;
+        IntrospectionCache *m_introspectionCache;
         std::map<OCDoHandle, DiscoverContext *> m_discovered;
+        std::multiset<DiscoverContext *> m_processing; /* contexts held by a DiscoverWork */
+        Executor *m_executor;
+        size_t m_probeWindow; /* Maximum number of outstanding probes per device */
+        uint32_t m_propertyMaxAgeMs;
+        uint32_t m_notifyWindowMs;
+        uint32_t m_notifyMaxLatencyMs;
         bool m_secureMode;
-        std::list<Task*> m_tasks;
+        TaskQueue *m_tasks;
         RDPublishTask *m_rdPublishTask;
-        size_t m_pending;
+        SaveCacheTask *m_saveCacheTask;
+        size_t m_pending; /* Number of handshake worker threads */
+        size_t m_maxHandshakes;
+        std::deque<Handshake *> m_knownHandshakes; /* Served before m_newHandshakes */
+        std::deque<Handshake *> m_newHandshakes;
+        std::set<std::string> m_knownPeers; /* GUIDs of peers that completed a handshake */
+        HandshakeStats m_handshakeStats;
         std::string m_ajSoftwareVersion;
 
+        void Wake();
+        void ScheduleRDPublish();
+        void ScheduleSaveCache();
         void WhoImplements();
         void Destroy(const char *id);
         virtual void BusDisconnected();
@@ -149,7 +190,8 @@ class Bridge : private ajn::AboutListener
         virtual void SessionLost(ajn::SessionId sessionId,
                 ajn::SessionListener::SessionLostReason reason);
         VirtualResource *CreateVirtualResource(ajn::BusAttachment *bus, const char *name,
-                ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion);
+                ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion,
+                const char *piid, const char *softwareVersion);
 
         OCRepPayload *GetSecureMode(OCEntityHandlerRequest *request);
         bool PostSecureMode(OCEntityHandlerRequest *request, bool &hasChanged);
@@ -157,6 +199,12 @@ class Bridge : private ajn::AboutListener
                 OCEntityHandlerRequest *request, void *context);
         static OCStackApplicationResult DiscoverCB(void *context, OCDoHandle handle,
                 OCClientResponse *response);
+        static OCStackApplicationResult ObserveResCB(void *ctx, OCDoHandle handle,
+                OCClientResponse *response);
+        void Discovered(const OCDevAddr &origin, OCDiscoveryPayload *payload);
+        void ObserveRes(DiscoverContext *context);
+        void DiscoverChurn();
+        void UpdateDiscoverPeriod();
         static OCStackApplicationResult GetPlatformCB(void *context, OCDoHandle handle,
                 OCClientResponse *response);
         static OCStackApplicationResult GetDeviceCB(void *context, OCDoHandle handle,
@@ -167,26 +215,50 @@ class Bridge : private ajn::AboutListener
                 OCClientResponse *response);
         static OCStackApplicationResult GetIntrospectionDataCB(void *ctx, OCDoHandle handle,
                 OCClientResponse *response);
+        typedef void (*DiscoverHandler)(Bridge *thiz, DiscoverContext *&context,
+                OCRepPayload *payload, const OCDevAddr *devAddr);
+        void Dispatch(OCDoHandle handle, OCClientResponse *response, DiscoverHandler handler);
+        static void ProcessDevice(Bridge *thiz, DiscoverContext *&context, OCRepPayload *payload,
+                const OCDevAddr *devAddr);
+        static void ProcessPlatform(Bridge *thiz, DiscoverContext *&context,
+                OCRepPayload *payload, const OCDevAddr *devAddr);
+        static void ProcessIntrospection(Bridge *thiz, DiscoverContext *&context,
+                OCRepPayload *payload, const OCDevAddr *devAddr);
+        static void ProcessIntrospectionData(Bridge *thiz, DiscoverContext *&context,
+                OCRepPayload *payload, const OCDevAddr *devAddr);
+        static void ProcessProbes(Bridge *thiz, DiscoverContext *&context,
+                OCRepPayload *payload, const OCDevAddr *devAddr);
+        static void AddProbeDefinition(DiscoverContext *context, OCRepPayload *payload);
+        void StartProbes(DiscoverContext *&context);
+        void IssueProbes(DiscoverContext *context);
         OCStackResult CreateInterface(DiscoverContext *context, OCRepPayload *payload);
         OCStackApplicationResult Get(void *ctx, OCDoHandle handle, OCClientResponse *response);
 
         SeenState GetSeenState(const char *piid);
         void DestroyPiid(const char *piid);
-        static void SecureConnection(Bridge *thiz, const char *name, void *ctx);
+        void QueueHandshake(void *ctx, const char *name);
+        void StartHandshakeWorkers();
+        void DropHandshakes();
+        static void HandshakeWorker(Bridge *thiz);
         void SecureConnectionCB(QStatus status, void *ctx);
 
         bool IsSelf(const OCDiscoveryPayload *payload);
         bool HasSeenBefore(const OCDiscoveryPayload *payload);
+        void AddFingerprint(const char *di, uint64_t resources, uint64_t reply);
+        void RemoveFingerprints(const char *di);
         bool IsSecure(const OCResourcePayload *resource);
         bool HasTranslatableResource(OCDiscoveryPayload *payload);
         void UpdatePresenceStatus(const OCDiscoveryPayload *payload);
         void GetContextAndRepPayload(OCDoHandle handle, OCClientResponse *response,
                 DiscoverContext **context, OCRepPayload **payload);
         void ParseIntrospectionPayload(DiscoverContext *context, OCRepPayload *payload);
+        OCStackResult ParseIntrospectionData(DiscoverContext *context, const char *data);
         OCStackResult ContinueDiscovery(DiscoverContext *context, const char *uri,
                 const std::vector<OCDevAddr> &addrs, OCClientResponseHandler cb);
         OCStackResult ContinueDiscovery(DiscoverContext *context, const char *uri, OCDevAddr *addr,
                 OCClientResponseHandler cb);
+        OCStackResult ResumeDiscovery(DiscoverContext *&context, const char *uri,
+                const std::vector<OCDevAddr> &addrs, OCClientResponseHandler cb);
 
         OCStackResult DoResource(OCDoHandle *handle, OCMethod method, const char *uri,
                 OCDevAddr *addr, OCClientResponseHandler cb);
@@ -20,13 +20,17 @@
 
 #include "Bridge.h"
 
+#include "Executor.h"
 #include "Introspection.h"
+#include "IntrospectionCache.h"
 #include "Name.h"
 #include "Payload.h"
 #include "Plugin.h"
 #include "Presence.h"
+#include "Registry.h"
 #include "Resource.h"
 #include "Security.h"
+#include "TaskQueue.h"
 #include "VirtualBusAttachment.h"
 #include "VirtualBusObject.h"
 #include "VirtualConfigBusObject.h"
@@ -41,6 +45,7 @@
 #include <alljoyn/AllJoynStd.h>
 #include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <deque>
 #include <iterator>
 #include <math.h>
@@ -53,6 +58,8 @@
 #define SECURE_MODE_DEFAULT false
 #endif
 
+#define INTROSPECTION_CACHE_FILE_NAME "introspection_cache.dat"
+
 static bool TranslateResourceType(const char *type)
 {
     return !(strcmp(type, OC_RSRVD_RESOURCE_TYPE_DEVICE) == 0 ||
@@ -67,6 +74,63 @@ static bool TranslateResourceType(const char *type)
              strcmp(type, "oic.r.securemode") == 0);
 }
 
+static uint64_t Hash(uint64_t hash, const void *data, size_t n)
+{
+    const uint8_t *p = (const uint8_t *) data;
+    for (size_t i = 0; i < n; ++i)
+    {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t Hash(uint64_t hash, const char *s)
+{
+    /* Include the terminator so that adjacent strings do not run together */
+    return s ? Hash(hash, s, strlen(s) + 1) : Hash(hash, "", 1);
+}
+
+/*
+ * Computes two fingerprints of a discovery reply without allocating: resources covers the sid
+ * and the uri, types, interfaces, and properties of each resource, reply additionally covers the
+ * endpoints of each resource.  The same device may reply with different endpoints on each of its
+ * interfaces, so only a change in resources is a change of the device.
+ */
+static void GetFingerprints(const OCDiscoveryPayload *payload, uint64_t *resources,
+        uint64_t *reply)
+{
+    uint64_t r = Hash(14695981039346656037ULL, payload->sid);
+    uint64_t e = r;
+    for (const OCResourcePayload *resource = payload->resources; resource;
+         resource = resource->next)
+    {
+        r = Hash(r, resource->uri);
+        for (const OCStringLL *type = resource->types; type; type = type->next)
+        {
+            r = Hash(r, type->value);
+        }
+        for (const OCStringLL *ifc = resource->interfaces; ifc; ifc = ifc->next)
+        {
+            r = Hash(r, ifc->value);
+        }
+        r = Hash(r, &resource->bitmap, sizeof(resource->bitmap));
+        r = Hash(r, &resource->secure, sizeof(resource->secure));
+        e = Hash(e, &resource->port, sizeof(resource->port));
+        e = Hash(e, &resource->tcpPort, sizeof(resource->tcpPort));
+        for (const OCEndpointPayload *ep = resource->eps; ep; ep = ep->next)
+        {
+            e = Hash(e, ep->tps);
+            e = Hash(e, ep->addr);
+            e = Hash(e, &ep->family, sizeof(ep->family));
+            e = Hash(e, &ep->port, sizeof(ep->port));
+            e = Hash(e, &ep->pri, sizeof(ep->pri));
+        }
+    }
+    *resources = r;
+    *reply = Hash(e, &r, sizeof(r));
+}
+
 std::vector<OCDevAddr> GetDevAddrs(OCDevAddr origin, const char *di, OCResourcePayload *resource)
 {
     if (resource->secure)
@@ -194,15 +258,32 @@ struct Device
 struct Bridge::DiscoverContext
 {
     Bridge *m_bridge;
+    OCDevAddr m_origin;
     Device m_device;
     VirtualBusAttachment *m_bus;
     OCRepPayload *m_paths;
     OCRepPayload *m_definitions;
+    std::string m_softwareVersion; /* Of the platform, identifies the cached introspection data */
+    bool m_cancelled; /* Protected by m_bridge->m_mutex */
+    uint64_t m_resources; /* Fingerprints of the discovery reply, see GetFingerprints() */
+    uint64_t m_reply;
+    /* Number of m_discovered entries and DiscoverWorks referring to this, protected by
+     * m_bridge->m_mutex */
+    size_t m_refs;
     DiscoverContext(Bridge *bridge, OCDevAddr origin, OCDiscoveryPayload *payload)
-        : m_bridge(bridge), m_device(origin, payload), m_bus(NULL), m_paths(NULL),
-          m_definitions(NULL) { }
-    ~DiscoverContext() { OCRepPayloadDestroy(m_paths); OCRepPayloadDestroy(m_definitions);
-        delete m_bus; }
+        : m_bridge(bridge), m_origin(origin), m_device(origin, payload), m_bus(NULL), m_paths(NULL),
+          m_definitions(NULL), m_cancelled(false), m_resources(0), m_reply(0), m_refs(0),
+          m_nextProbe(0) { }
+    ~DiscoverContext()
+    {
+        OCRepPayloadDestroy(m_paths);
+        OCRepPayloadDestroy(m_definitions);
+        for (OCRepPayload *reply : m_replies)
+        {
+            OCRepPayloadDestroy(reply);
+        }
+        delete m_bus;
+    }
     std::vector<OCDevAddr> GetDevAddrs(const char *uri)
     {
         Resource *resource = m_device.GetResourceUri(uri);
@@ -291,13 +372,115 @@ struct Bridge::DiscoverContext
     Iterator Begin() { return Iterator(this, true); }
     Iterator End() { return Iterator(this, false); }
     Iterator m_it;
+
+    /* Probes of a device without an introspection resource, protected by m_bridge->m_mutex */
+    std::vector<Iterator> m_probes;
+    std::vector<OCRepPayload *> m_replies;
+    std::map<OCDoHandle, size_t> m_probeHandles;
+    size_t m_nextProbe;
+};
+
+/* One step of discovering a device, run on the strand of the device. */
+struct Bridge::DiscoverWork : public Executor::Work
+{
+    Bridge *m_bridge;
+    DiscoverHandler m_handler;
+    DiscoverContext *m_context;
+    OCRepPayload *m_payload;
+    OCDevAddr m_devAddr;
+    DiscoverWork(Bridge *bridge, DiscoverHandler handler, DiscoverContext *context,
+            OCRepPayload *payload, const OCDevAddr &devAddr)
+        : m_bridge(bridge), m_handler(handler), m_context(context), m_payload(payload),
+          m_devAddr(devAddr) { }
+    virtual ~DiscoverWork()
+    {
+        OCRepPayloadDestroy(m_payload);
+        if (m_context)
+        {
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(m_bridge->m_mutex);
+                m_bridge->m_processing.erase(m_bridge->m_processing.find(m_context));
+                last = (--m_context->m_refs == 0);
+            }
+            if (last)
+            {
+                delete m_context;
+            }
+        }
+    }
+    virtual void Run() { m_handler(m_bridge, m_context, m_payload, &m_devAddr); }
+};
+
+struct Bridge::Task : public TaskQueue::Task
+{
+    virtual ~Task() { }
+    virtual void Run(Bridge *thiz) = 0;
+    /* Returns true if the task must be cancelled when id is destroyed. */
+    virtual bool BelongsTo(const char *id) const { (void) id; return false; }
+};
+
+struct Bridge::AnnouncedTask : public Bridge::Task
+{
+    std::string m_name;
+    std::string m_piid;
+    bool m_isVirtual;
+    AnnouncedTask(const char *name, const char *piid, bool isVirtual)
+        : m_name(name), m_piid(piid), m_isVirtual(isVirtual) { }
+    virtual ~AnnouncedTask() { }
+    virtual void Run(Bridge *thiz);
+};
+
+struct Bridge::DiscoverTask : public Bridge::Task
+{
+    std::string m_piid;
+    OCRepPayload *m_payload;
+    DiscoverContext *m_context;
+    DiscoverTask(const char *piid, OCRepPayload *payload, DiscoverContext *context)
+        : m_piid(piid), m_payload(OCRepPayloadClone(payload)), m_context(context) { }
+    virtual ~DiscoverTask() { OCRepPayloadDestroy(m_payload); delete m_context; }
+    virtual void Run(Bridge *thiz);
+    virtual bool BelongsTo(const char *id) const
+    {
+        return m_context && (m_context->m_device.m_di == id);
+    }
+};
+
+struct Bridge::RDPublishTask : public Bridge::Task
+{
+    virtual ~RDPublishTask() { }
+    virtual void Run(Bridge *thiz);
+};
+
+struct Bridge::SaveCacheTask : public Bridge::Task
+{
+    virtual ~SaveCacheTask() { }
+    virtual void Run(Bridge *thiz);
+};
+
+struct Bridge::NotifyTask : public Bridge::Task
+{
+    std::string m_id;
+    std::string m_path;
+    NotifyTask(const char *id, const char *path) : m_id(id), m_path(path) { }
+    virtual ~NotifyTask() { }
+    virtual void Run(Bridge *thiz);
+    virtual bool BelongsTo(const char *id) const { return m_id == id; }
 };
 
 Bridge::Bridge(const char *name, Protocol protocols)
-    : m_execCb(NULL), m_sessionLostCb(NULL), m_protocols(protocols), m_sender(NULL),
-      m_discoverHandle(NULL), m_discoverNextTick(0), m_secureMode(SECURE_MODE_DEFAULT),
-      m_rdPublishTask(NULL), m_pending(0)
+    : m_execCb(NULL), m_sessionLostCb(NULL), m_wake(false), m_protocols(protocols),
+      m_sender(NULL), m_discoverHandle(NULL), m_discoverNextTick(0),
+      m_discoverPeriodMs(DISCOVER_PERIOD_SECS * 1000), m_discoverChurn(true),
+      m_probeWindow(PROBE_WINDOW_DEFAULT), m_propertyMaxAgeMs(0), m_notifyWindowMs(0),
+      m_notifyMaxLatencyMs(0), m_secureMode(SECURE_MODE_DEFAULT),
+      m_rdPublishTask(NULL), m_saveCacheTask(NULL), m_pending(0),
+      m_maxHandshakes(MAX_HANDSHAKES_DEFAULT), m_handshakeStats()
 {
+    m_executor = new Executor(std::max(std::thread::hardware_concurrency(), 1u));
+    m_registry = new Registry();
+    m_introspectionCache = new IntrospectionCache(INTROSPECTION_CACHE_FILE_NAME);
+    m_tasks = new TaskQueue();
     m_bus = new ajn::BusAttachment(name, true);
     m_ajState = CREATED;
     m_ajSecurity = new AllJoynSecurity(m_bus, AllJoynSecurity::CONSUMER);
@@ -305,10 +488,18 @@ Bridge::Bridge(const char *name, Protocol protocols)
 }
 
 Bridge::Bridge(const char *name, const char *sender)
-    : m_execCb(NULL), m_sessionLostCb(NULL), m_protocols(AJ), m_sender(sender),
-      m_discoverHandle(NULL), m_discoverNextTick(0), m_secureMode(SECURE_MODE_DEFAULT),
-      m_rdPublishTask(NULL), m_pending(0)
+    : m_execCb(NULL), m_sessionLostCb(NULL), m_wake(false), m_protocols(AJ),
+      m_sender(sender), m_discoverHandle(NULL), m_discoverNextTick(0),
+      m_discoverPeriodMs(DISCOVER_PERIOD_SECS * 1000), m_discoverChurn(true),
+      m_probeWindow(PROBE_WINDOW_DEFAULT), m_propertyMaxAgeMs(0), m_notifyWindowMs(0),
+      m_notifyMaxLatencyMs(0), m_secureMode(SECURE_MODE_DEFAULT),
+      m_rdPublishTask(NULL), m_saveCacheTask(NULL), m_pending(0),
+      m_maxHandshakes(MAX_HANDSHAKES_DEFAULT), m_handshakeStats()
 {
+    m_executor = new Executor(std::max(std::thread::hardware_concurrency(), 1u));
+    m_registry = new Registry();
+    m_introspectionCache = new IntrospectionCache(INTROSPECTION_CACHE_FILE_NAME);
+    m_tasks = new TaskQueue();
     m_bus = new ajn::BusAttachment(name, true);
     m_ajState = CREATED;
     m_ajSecurity = new AllJoynSecurity(m_bus, AllJoynSecurity::CONSUMER);
@@ -319,39 +510,38 @@ Bridge::~Bridge()
 {
     LOG(LOG_INFO, "[%p]", this);
 
+    Executor *executor;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        executor = m_executor;
+        m_executor = NULL;
+    }
+    /* Outstanding discovery work needs m_mutex to finish or clean up */
+    delete executor;
     {
         std::unique_lock<std::mutex> lock(m_mutex);
+        DropHandshakes();
         while (m_pending > 0)
         {
             m_cond.wait(lock);
         }
-        for (Presence *presence : m_presence)
-        {
-            delete presence;
-        }
-        m_presence.clear();
         for (auto &dc : m_discovered)
         {
             DiscoverContext *discoverContext = dc.second;
-            delete discoverContext;
+            if (--discoverContext->m_refs == 0)
+            {
+                delete discoverContext;
+            }
         }
         m_discovered.clear();
-        for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
-        {
-            delete busAttachment;
-        }
-        m_virtualBusAttachments.clear();
-        for (VirtualResource *resource : m_virtualResources)
-        {
-            delete resource;
-        }
-        m_virtualResources.clear();
-        for (VirtualDevice *device : m_virtualDevices)
-        {
-            delete device;
-        }
-        m_virtualDevices.clear();
-    }
+        delete m_registry;
+        m_registry = NULL;
+        m_saveCacheTask = NULL;
+        delete m_tasks;
+        m_tasks = NULL;
+        m_rdPublishTask = NULL;
+    }
+    delete m_introspectionCache;
     delete m_ocSecurity;
     delete m_ajSecurity;
     delete m_bus;
@@ -360,76 +550,54 @@ Bridge::~Bridge()
 /* Called with m_mutex held. */
 void Bridge::Destroy(const char *id)
 {
-    std::map<OCDoHandle, DiscoverContext *>::iterator dc = m_discovered.begin();
-    while (dc != m_discovered.end())
+    std::vector<Task *> tasks;
+    for (std::vector<TaskQueue::Task *>::const_iterator it = m_tasks->Begin();
+         it != m_tasks->End(); ++it)
     {
-        DiscoverContext *context = dc->second;
-        if (context->m_device.m_di == id)
-        {
-            delete context;
-            dc = m_discovered.erase(dc);
-        }
-        else
+        Task *task = static_cast<Task *>(*it);
+        if (task->BelongsTo(id))
         {
-            ++dc;
+            tasks.push_back(task);
         }
     }
-    std::vector<VirtualBusAttachment *>::iterator vba = m_virtualBusAttachments.begin();
-    while (vba != m_virtualBusAttachments.end())
+    for (Task *task : tasks)
     {
-        VirtualBusAttachment *busAttachment = *vba;
-        if (busAttachment->GetDi() == id)
-        {
-            delete busAttachment;
-            vba = m_virtualBusAttachments.erase(vba);
-        }
-        else
-        {
-            ++vba;
-        }
+        m_tasks->Cancel(task);
+        delete task;
     }
-    std::vector<VirtualResource *>::iterator vr = m_virtualResources.begin();
-    while (vr != m_virtualResources.end())
+    for (DiscoverContext *context : m_processing)
     {
-        VirtualResource *resource = *vr;
-        if (resource->GetUniqueName() == id)
-        {
-            delete resource;
-            vr = m_virtualResources.erase(vr);
-        }
-        else
+        if (context->m_device.m_di == id)
         {
-            ++vr;
+            context->m_cancelled = true;
         }
     }
-    std::vector<VirtualDevice *>::iterator vd = m_virtualDevices.begin();
-    while (vd != m_virtualDevices.end())
+    RemoveFingerprints(id);
+    std::map<std::string, ResObserve>::iterator observe = m_resObserves.find(id);
+    if (observe != m_resObserves.end())
     {
-        VirtualDevice *device = *vd;
-        if (device->GetName() == id)
-        {
-            delete device;
-            vd = m_virtualDevices.erase(vd);
-        }
-        else
-        {
-            ++vd;
-        }
+        Cancel(observe->second.m_handle, OC_LOW_QOS);
+        m_resObserves.erase(observe);
     }
-    std::vector<Presence *>::iterator p = m_presence.begin();
-    while (p != m_presence.end())
+    std::map<OCDoHandle, DiscoverContext *>::iterator dc = m_discovered.begin();
+    while (dc != m_discovered.end())
     {
-        Presence *presence = *p;
-        if (presence->GetId() == id)
+        DiscoverContext *context = dc->second;
+        if (context->m_device.m_di == id)
         {
-            delete presence;
-            p = m_presence.erase(p);
+            context->m_cancelled = true;
+            if (--context->m_refs == 0)
+            {
+                delete context;
+            }
+            dc = m_discovered.erase(dc);
         }
         else
         {
-            ++p;
+            ++dc;
         }
     }
+    m_registry->Destroy(id);
 }
 
 bool Bridge::Start()
@@ -440,6 +608,11 @@ bool Bridge::Start()
     {
         return false;
     }
+    OCPersistentStorage *ps = OCGetPersistentStorageHandler();
+    if (ps)
+    {
+        m_introspectionCache->Load(ps);
+    }
     if (!m_sender)
     {
         OCResourceHandle handle = OCGetResourceHandleAtUri(OC_RSRVD_DEVICE_URI);
@@ -498,9 +671,12 @@ bool Bridge::Stop()
     LOG(LOG_INFO, "[%p]", this);
 
     std::lock_guard<std::mutex> lock(m_mutex);
-    for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
+    for (Registry::Iterator it = m_registry->Begin(); it != m_registry->End(); ++it)
     {
-        busAttachment->Stop();
+        if (it->second->m_bus)
+        {
+            it->second->m_bus->Stop();
+        }
     }
     if (m_discoverHandle)
     {
@@ -511,6 +687,19 @@ bool Bridge::Stop()
         }
         m_discoverHandle = NULL;
     }
+    for (auto &observe : m_resObserves)
+    {
+        Cancel(observe.second.m_handle, OC_LOW_QOS);
+    }
+    m_resObserves.clear();
+    if (m_saveCacheTask)
+    {
+        /* Save now rather than lose the entries added since the last save */
+        SaveCacheTask *task = m_saveCacheTask;
+        m_tasks->Cancel(task);
+        task->Run(this);
+        delete task;
+    }
     return true;
 }
 
@@ -554,7 +743,7 @@ bool Bridge::Process()
     }
     if (m_protocols & OC)
     {
-        if (time(NULL) >= m_discoverNextTick)
+        if (GetMonotonicMs() >= m_discoverNextTick)
         {
             if (m_discoverHandle)
             {
@@ -579,13 +768,15 @@ bool Bridge::Process()
             {
                 LOG(LOG_ERR, "DoResource(OC_REST_DISCOVER) - %d", result);
             }
-            m_discoverNextTick = time(NULL) + DISCOVER_PERIOD_SECS;
+            UpdateDiscoverPeriod();
+            m_discoverNextTick = GetMonotonicMs() + m_discoverPeriodMs;
         }
     }
     std::vector<std::string> absent;
-    for (Presence *presence : m_presence)
+    for (Registry::Iterator it = m_registry->Begin(); it != m_registry->End(); ++it)
     {
-        if (!presence->IsPresent())
+        Presence *presence = it->second->m_presence;
+        if (presence && !presence->IsPresent())
         {
             absent.push_back(presence->GetId());
         }
@@ -594,36 +785,53 @@ bool Bridge::Process()
     {
         LOG(LOG_INFO, "[%p] %s absent", this, id.c_str());
         Destroy(id.c_str());
+        DiscoverChurn();
     }
-    std::list<Task *>::iterator task = m_tasks.begin();
-    while (task != m_tasks.end())
+    uint64_t now = GetMonotonicMs();
+    Task *task;
+    while ((task = static_cast<Task *>(m_tasks->Pop(now))) != NULL)
     {
-        if (time(NULL) >= (*task)->m_tick)
-        {
-            (*task)->Run(this);
-            delete (*task);
-            task = m_tasks.erase(task);
-        }
-        else
-        {
-            ++task;
-        }
+        task->Run(this);
+        delete task;
     }
     return true;
 }
 
+void Bridge::Wait(uint32_t timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t now = GetMonotonicMs();
+    uint64_t deadline = std::min(now + timeoutMs, m_tasks->GetNextTick());
+    if (m_protocols & OC)
+    {
+        deadline = std::min(deadline, m_discoverNextTick);
+    }
+    if (deadline > now)
+    {
+        m_wakeCond.wait_for(lock, std::chrono::milliseconds(deadline - now),
+                [this]() { return m_wake; });
+    }
+    m_wake = false;
+}
+
+/* Called with m_mutex held. */
+void Bridge::Wake()
+{
+    m_wake = true;
+    m_wakeCond.notify_one();
+}
+
 void Bridge::BusDisconnected()
 {
     LOG(LOG_INFO, "[%p]", this);
     std::lock_guard<std::mutex> lock(m_mutex);
-    std::set<std::string> ids;
-    for (VirtualResource *resource : m_virtualResources)
+    std::vector<std::string> ids;
+    for (Registry::Iterator it = m_registry->Begin(); it != m_registry->End(); ++it)
     {
-        ids.insert(resource->GetUniqueName());
-    }
-    for (VirtualDevice *device : m_virtualDevices)
-    {
-        ids.insert(device->GetName());
+        if (it->second->m_device || !it->second->m_resources.empty())
+        {
+            ids.push_back(it->first);
+        }
     }
     for (const std::string &id : ids)
     {
@@ -631,6 +839,7 @@ void Bridge::BusDisconnected()
         Destroy(id.c_str());
     }
     m_ajState = STARTED;
+    Wake();
 }
 
 void Bridge::WhoImplements()
@@ -676,26 +885,15 @@ void Bridge::Announced(const char *name, uint16_t version, ajn::SessionPort port
 
     m_mutex.lock();
     /* Ignore Announce from self */
-    for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
+    if (m_registry->FindByBusName(name))
     {
-        if (busAttachment->GetUniqueName() == name)
-        {
-            m_mutex.unlock();
-            return;
-        }
+        m_mutex.unlock();
+        return;
     }
 
     /* Check if we've seen this Announce before */
-    VirtualDevice *device = NULL;
-    for (std::vector<VirtualDevice *>::iterator it = m_virtualDevices.begin();
-         it != m_virtualDevices.end(); ++it)
-    {
-        if ((*it)->GetName() == name)
-        {
-            device = *it;
-            break;
-        }
-    }
+    Registry::Entry *entry = m_registry->Find(name);
+    VirtualDevice *device = entry ? entry->m_device : NULL;
 
     context = new AnnouncedContext(device, name, objectDescriptionArg, aboutDataArg);
     if (device)
@@ -736,20 +934,156 @@ void Bridge::JoinSessionCB(QStatus status, ajn::SessionId sessionId, const ajn::
         context->m_sessionId = sessionId;
 
         /* BusAttachment::SecureConnectionAsync is not really usable (no means to pass context). */
+        QueueHandshake(ctx, context->m_name.c_str());
+    }
+}
+
+struct Bridge::Handshake
+{
+    void *m_ctx;
+    std::string m_name;
+    std::string m_peerGuid;
+    uint64_t m_queuedTick;
+    Handshake(void *ctx, const char *name, const char *peerGuid)
+        : m_ctx(ctx), m_name(name), m_peerGuid(peerGuid), m_queuedTick(GetMonotonicMs()) { }
+};
+
+/* Called with m_mutex held. */
+void Bridge::QueueHandshake(void *ctx, const char *name)
+{
+    AnnouncedContext *context = reinterpret_cast<AnnouncedContext *>(ctx);
+    qcc::String peerGuid;
+    m_bus->GetPeerGUID(name, peerGuid);
+    Handshake *handshake = new Handshake(ctx, name, peerGuid.c_str());
+    /*
+     * Peers we already have a device for, or that completed a handshake before (for example
+     * prior to a router restart), go first so that existing devices come back quickly.
+     */
+    if (context->m_device || (m_knownPeers.find(handshake->m_peerGuid) != m_knownPeers.end()))
+    {
+        m_knownHandshakes.push_back(handshake);
+    }
+    else
+    {
+        m_newHandshakes.push_back(handshake);
+    }
+    StartHandshakeWorkers();
+}
+
+/* Called with m_mutex held. */
+void Bridge::StartHandshakeWorkers()
+{
+    size_t wanted = m_handshakeStats.m_active + m_knownHandshakes.size() + m_newHandshakes.size();
+    wanted = std::min(wanted, m_maxHandshakes);
+    while (m_pending < wanted)
+    {
         ++m_pending;
-        std::thread(Bridge::SecureConnection, this, context->m_name.c_str(), ctx).detach();
+        std::thread(Bridge::HandshakeWorker, this).detach();
     }
 }
 
-void Bridge::SecureConnection(Bridge *thiz, const char *name, void *ctx)
+/* Called with m_mutex held. */
+void Bridge::DropHandshakes()
 {
-    QStatus status = thiz->m_bus->SecureConnection(name);
-    thiz->SecureConnectionCB(status, ctx);
+    std::deque<Handshake *> *queues[] = { &m_knownHandshakes, &m_newHandshakes };
+    for (std::deque<Handshake *> *queue : queues)
     {
-        std::lock_guard<std::mutex> lock(thiz->m_mutex);
-        --thiz->m_pending;
-        thiz->m_cond.notify_one();
+        for (Handshake *handshake : *queue)
+        {
+            delete reinterpret_cast<AnnouncedContext *>(handshake->m_ctx);
+            delete handshake;
+        }
+        queue->clear();
+    }
+}
+
+void Bridge::HandshakeWorker(Bridge *thiz)
+{
+    std::unique_lock<std::mutex> lock(thiz->m_mutex);
+    while (thiz->m_pending <= thiz->m_maxHandshakes)
+    {
+        Handshake *handshake;
+        if (!thiz->m_knownHandshakes.empty())
+        {
+            handshake = thiz->m_knownHandshakes.front();
+            thiz->m_knownHandshakes.pop_front();
+        }
+        else if (!thiz->m_newHandshakes.empty())
+        {
+            handshake = thiz->m_newHandshakes.front();
+            thiz->m_newHandshakes.pop_front();
+        }
+        else
+        {
+            break;
+        }
+        ++thiz->m_handshakeStats.m_active;
+        lock.unlock();
+
+        uint64_t startTick = GetMonotonicMs();
+        QStatus status = thiz->m_bus->SecureConnection(handshake->m_name.c_str());
+        uint64_t handshakeMs = GetMonotonicMs() - startTick;
+        thiz->SecureConnectionCB(status, handshake->m_ctx);
+
+        lock.lock();
+        --thiz->m_handshakeStats.m_active;
+        if (status == ER_OK)
+        {
+            ++thiz->m_handshakeStats.m_completed;
+            if (!handshake->m_peerGuid.empty())
+            {
+                thiz->m_knownPeers.insert(handshake->m_peerGuid);
+            }
+        }
+        else
+        {
+            ++thiz->m_handshakeStats.m_failed;
+        }
+        thiz->m_handshakeStats.m_totalQueuedMs += startTick - handshake->m_queuedTick;
+        thiz->m_handshakeStats.m_totalHandshakeMs += handshakeMs;
+        thiz->m_handshakeStats.m_maxHandshakeMs =
+                std::max(thiz->m_handshakeStats.m_maxHandshakeMs, handshakeMs);
+        LOG(LOG_INFO, "[%p] name=%s,status=%s,queuedMs=%" PRIu64 ",handshakeMs=%" PRIu64, thiz,
+                handshake->m_name.c_str(), QCC_StatusText(status),
+                startTick - handshake->m_queuedTick, handshakeMs);
+        delete handshake;
     }
+    --thiz->m_pending;
+    thiz->m_cond.notify_one();
+}
+
+void Bridge::SetMaxHandshakes(size_t maxHandshakes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxHandshakes = std::max(maxHandshakes, (size_t) 1);
+    StartHandshakeWorkers();
+}
+
+void Bridge::SetProbeWindow(size_t window)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_probeWindow = std::max(window, (size_t) 1);
+}
+
+void Bridge::SetPropertyMaxAge(uint32_t maxAgeMs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_propertyMaxAgeMs = maxAgeMs;
+}
+
+void Bridge::SetNotifyCoalescing(uint32_t windowMs, uint32_t maxLatencyMs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_notifyWindowMs = windowMs;
+    m_notifyMaxLatencyMs = maxLatencyMs;
+}
+
+Bridge::HandshakeStats Bridge::GetHandshakeStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    HandshakeStats stats = m_handshakeStats;
+    stats.m_queued = m_knownHandshakes.size() + m_newHandshakes.size();
+    return stats;
 }
 
 void Bridge::SecureConnectionCB(QStatus status, void *ctx)
@@ -793,8 +1127,9 @@ void Bridge::SecureConnectionCB(QStatus status, void *ctx)
                     /* Delay creating virtual resources from a virtual Announce */
                     LOG(LOG_INFO, "[%p] Delaying creation of virtual resources from a virtual device",
                             this);
-                    m_tasks.push_back(new AnnouncedTask(time(NULL) + 10, context->m_name.c_str(),
-                            piidStr, isVirtual));
+                    m_tasks->Schedule(new AnnouncedTask(context->m_name.c_str(), piidStr,
+                            isVirtual), GetMonotonicMs() + 10 * 1000);
+                    Wake();
                 }
                 break;
         }
@@ -832,9 +1167,10 @@ static bool ComparePath(const char *a, const char *b)
     return (strcmp(a, b) < 0);
 }
 
+/* Called with m_mutex held. */
 VirtualResource *Bridge::CreateVirtualResource(ajn::BusAttachment *bus,
         const char *name, ajn::SessionId sessionId, const char *path,
-        const char *ajSoftwareVersion)
+        const char *ajSoftwareVersion, const char *piid, const char *softwareVersion)
 {
     if (!strcmp(path, "/Config"))
     {
@@ -843,7 +1179,21 @@ VirtualResource *Bridge::CreateVirtualResource(ajn::BusAttachment *bus,
     }
     else
     {
-        return VirtualResource::Create(this, bus, name, sessionId, path, ajSoftwareVersion);
+        bool useCache = piid && piid[0] && softwareVersion && softwareVersion[0];
+        VirtualResource *resource = VirtualResource::Create(this, bus, name, sessionId, path,
+                ajSoftwareVersion, useCache ? m_introspectionCache : NULL, piid,
+                softwareVersion);
+        if (resource)
+        {
+            resource->SetPropertyMaxAge(m_propertyMaxAgeMs);
+            resource->SetNotifyCoalescing(m_notifyWindowMs, m_notifyMaxLatencyMs);
+        }
+        if (resource && resource->IsFromCache())
+        {
+            /* No IntrospectCB will follow to publish the resource */
+            ScheduleRDPublish();
+        }
+        return resource;
     }
 }
 
@@ -862,6 +1212,16 @@ void Bridge::GetAboutDataCB(ajn::Message &msg, void *ctx)
         LOG(LOG_INFO, "[%p] %s AJSoftwareVersion=%s", this, QCC_StatusText(status),
             ajSoftwareVersion ? ajSoftwareVersion : "unknown");
         m_ajSoftwareVersion = ajSoftwareVersion;
+        char *softwareVersion = NULL;
+        aboutData.GetSoftwareVersion(&softwareVersion);
+        qcc::String peerGuid;
+        m_bus->GetPeerGUID(context->m_name.c_str(), peerGuid);
+        OCUUIdentity piid;
+        char piidStr[UUID_STRING_SIZE] = { 0 };
+        if (GetPiid(&piid, peerGuid.c_str(), &aboutData))
+        {
+            OCConvertUuidToString(piid.id, piidStr);
+        }
         if (context->m_device)
         {
             context->m_device->SetInfo(objectDescription, aboutData);
@@ -879,53 +1239,45 @@ void Bridge::GetAboutDataCB(ajn::Message &msg, void *ctx)
             const char **pa = new const char *[n];
             objectDescription.GetPaths(pa, n);
             std::sort(pa, pa + n, ComparePath);
-            std::vector<const char *> pb;
-            for (VirtualResource *resource : m_virtualResources)
+            /* The registry keeps the paths of a device sorted */
+            std::vector<std::string> pb;
+            Registry::Entry *entry = m_registry->Find(context->m_name);
+            if (entry)
             {
-                if (resource->GetUniqueName() == context->m_name.c_str())
+                for (auto &r : entry->m_resources)
                 {
-                    pb.push_back(resource->GetPath().c_str());
+                    pb.push_back(r.first);
                 }
             }
-            std::sort(pb.begin(), pb.end(), ComparePath);
-            std::vector<const char *> remove;
+            std::vector<std::string> remove;
             std::set_difference(pb.begin(), pb.end(),
                                 pa, pa + n,
-                                std::inserter(remove, remove.begin()), ComparePath);
+                                std::inserter(remove, remove.begin()));
+            std::vector<std::string> add;
+            std::set_difference(pa, pa + n,
+                                pb.begin(), pb.end(),
+                                std::inserter(add, add.begin()));
+            delete[] pa;
             for (size_t i = 0; i < remove.size(); ++i)
             {
-                for (std::vector<VirtualResource *>::iterator vr = m_virtualResources.begin();
-                     vr != m_virtualResources.end(); ++vr)
-                {
-                    VirtualResource *resource = *vr;
-                    if (resource->GetUniqueName() == context->m_name.c_str() &&
-                        resource->GetPath() == remove[i])
-                    {
-                        delete resource;
-                        m_virtualResources.erase(vr);
-                        break;
-                    }
-                }
+                m_registry->RemoveResource(context->m_name, remove[i]);
             }
-            std::vector<const char *> add;
-            std::set_difference(pa, pa + n,
-                                pb.begin(), pb.end(),
-                                std::inserter(add, add.begin()), ComparePath);
             for (size_t i = 0; i < add.size(); ++i)
             {
                 VirtualResource *resource = CreateVirtualResource(m_bus,
-                                            context->m_name.c_str(), msg->GetSessionId(), add[i],
-                                            ajSoftwareVersion);
+                                            context->m_name.c_str(), msg->GetSessionId(),
+                                            add[i].c_str(), ajSoftwareVersion, piidStr,
+                                            softwareVersion);
                 if (resource)
                 {
-                    m_virtualResources.push_back(resource);
+                    m_registry->AddResource(context->m_name, resource);
                 }
             }
         }
         else
         {
             Presence *presence = new AllJoynPresence(m_bus, context->m_name);
-            m_presence.push_back(presence);
+            m_registry->AddPresence(context->m_name, presence);
             VirtualDevice *device = new VirtualDevice(m_bus, msg->GetSender(), msg->GetSessionId());
             device->SetInfo(objectDescription, aboutData);
             OCResourceHandle handle = OCGetResourceHandleAtUri(OC_RSRVD_DEVICE_URI);
@@ -938,7 +1290,7 @@ void Bridge::GetAboutDataCB(ajn::Message &msg, void *ctx)
             {
                 LOG(LOG_ERR, "OCBindResourceTypeToResource() - %d", result);
             }
-            m_virtualDevices.push_back(device);
+            m_registry->AddDevice(context->m_name, device);
             size_t numPaths = objectDescription.GetPaths(NULL, 0);
             const char **paths = new const char *[numPaths];
             objectDescription.GetPaths(paths, numPaths);
@@ -946,10 +1298,10 @@ void Bridge::GetAboutDataCB(ajn::Message &msg, void *ctx)
             {
                 VirtualResource *resource = CreateVirtualResource(m_bus,
                                             context->m_name.c_str(), msg->GetSessionId(), paths[i],
-                                            ajSoftwareVersion);
+                                            ajSoftwareVersion, piidStr, softwareVersion);
                 if (resource)
                 {
-                    m_virtualResources.push_back(resource);
+                    m_registry->AddResource(context->m_name, resource);
                 }
             }
             delete[] paths;
@@ -981,29 +1333,26 @@ void Bridge::SessionLost(ajn::SessionId sessionId, ajn::SessionListener::Session
     LOG(LOG_INFO, "[%p] sessionId=%d,reason=%d", this, sessionId, reason);
 
     std::lock_guard<std::mutex> lock(m_mutex);
-    for (VirtualDevice *device : m_virtualDevices)
+    Registry::Entry *entry = m_registry->FindBySessionId(sessionId);
+    if (entry)
     {
-        if (device->GetSessionId() == sessionId)
-        {
-            Destroy(device->GetName().c_str());
-            break;
-        }
+        std::string id = entry->m_id;
+        Destroy(id.c_str());
     }
 
     if (m_sessionLostCb)
     {
         m_sessionLostCb();
+        Wake();
     }
 }
 
 void Bridge::UpdatePresenceStatus(const OCDiscoveryPayload *payload)
 {
-    for (Presence *p : m_presence)
+    Registry::Entry *entry = m_registry->Find(payload->sid);
+    if (entry && entry->m_presence)
     {
-        if (p->GetId() == payload->sid)
-        {
-            p->Seen();
-        }
+        entry->m_presence->Seen();
     }
 }
 
@@ -1014,16 +1363,22 @@ bool Bridge::IsSelf(const OCDiscoveryPayload *payload)
 
 bool Bridge::HasSeenBefore(const OCDiscoveryPayload *payload)
 {
-    for (VirtualBusAttachment *b : m_virtualBusAttachments)
+    Registry::Entry *entry = m_registry->Find(payload->sid);
+    if (entry && entry->m_bus)
+    {
+        return true;
+    }
+    /* Discoveries in progress are few and short-lived */
+    for (auto &d : m_discovered)
     {
-        if (b->GetDi() == payload->sid)
+        if (d.second->m_device.m_di == payload->sid)
         {
             return true;
         }
     }
-    for (auto &d : m_discovered)
+    for (DiscoverContext *context : m_processing)
     {
-        if (d.second->m_device.m_di == payload->sid)
+        if (context->m_device.m_di == payload->sid)
         {
             return true;
         }
@@ -1123,6 +1478,7 @@ OCStackResult Bridge::ContinueDiscovery(DiscoverContext *context, const char *ur
     {
         LOG(LOG_INFO, "Get(%s)", uri);
         m_discovered[cbHandle] = context;
+        ++context->m_refs;
     }
     return result;
 }
@@ -1136,10 +1492,61 @@ OCStackResult Bridge::ContinueDiscovery(DiscoverContext *context, const char *ur
     {
         LOG(LOG_INFO, "Get(%s)", uri);
         m_discovered[cbHandle] = context;
+        ++context->m_refs;
+    }
+    return result;
+}
+
+/* Called from a DiscoverWork, context is set to NULL when ownership returns to m_discovered. */
+OCStackResult Bridge::ResumeDiscovery(DiscoverContext *&context, const char *uri,
+        const std::vector<OCDevAddr> &addrs, OCClientResponseHandler cb)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (context->m_cancelled)
+    {
+        LOG(LOG_INFO, "[%p] Discovery of %s cancelled", this, context->m_device.m_di.c_str());
+        return OC_STACK_ERROR;
+    }
+    OCStackResult result = ContinueDiscovery(context, uri, addrs, cb);
+    if (result == OC_STACK_OK)
+    {
+        m_processing.erase(m_processing.find(context));
+        --context->m_refs;
+        context = NULL;
     }
     return result;
 }
 
+/*
+ * Moves the context of the response out of m_discovered and posts the rest of the processing to
+ * the strand of the device.  The OC stack frees the response when the callback returns, so the
+ * payload is cloned.
+ */
+void Bridge::Dispatch(OCDoHandle handle, OCClientResponse *response, DiscoverHandler handler)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DiscoverContext *context;
+    OCRepPayload *payload;
+    GetContextAndRepPayload(handle, response, &context, &payload);
+    m_discovered.erase(handle);
+    if (!context)
+    {
+        return;
+    }
+    if (!m_executor)
+    {
+        if (--context->m_refs == 0)
+        {
+            delete context;
+        }
+        return;
+    }
+    /* The reference held by handle moves to the DiscoverWork */
+    m_processing.insert(context);
+    m_executor->Post(context->m_device.m_di, new DiscoverWork(this, handler, context,
+            payload ? OCRepPayloadClone(payload) : NULL, response->devAddr));
+}
+
 OCStackApplicationResult Bridge::DiscoverCB(void *ctx, OCDoHandle handle,
         OCClientResponse *response)
 {
@@ -1154,94 +1561,284 @@ OCStackApplicationResult Bridge::DiscoverCB(void *ctx, OCDoHandle handle,
     OCDiscoveryPayload *payload;
     for (payload = (OCDiscoveryPayload *) response->payload; payload; payload = payload->next)
     {
-        DiscoverContext *context = NULL;
-        std::vector<OCDevAddr> addrs;
-        OCStackResult result;
-        thiz->UpdatePresenceStatus(payload);
-        if (thiz->IsSelf(payload) || thiz->HasSeenBefore(payload) ||
-                !thiz->HasTranslatableResource(payload))
+        thiz->Discovered(response->devAddr, payload);
+    }
+
+exit:
+    return OC_STACK_KEEP_TRANSACTION;
+}
+
+/*
+ * Called with m_mutex held.  Every bridge on the network replies to every multicast discovery,
+ * so most replies are repeats.  Those are recognized by their fingerprint before doing anything
+ * else.
+ */
+void Bridge::Discovered(const OCDevAddr &origin, OCDiscoveryPayload *payload)
+{
+    DiscoverContext *context = NULL;
+    Registry::Entry *entry;
+    uint64_t resources, reply;
+    OCStackResult result;
+    GetFingerprints(payload, &resources, &reply);
+    UpdatePresenceStatus(payload);
+    if (m_fingerprints.find(reply) != m_fingerprints.end())
+    {
+        goto exit;
+    }
+    if (IsSelf(payload) || !HasTranslatableResource(payload))
+    {
+        AddFingerprint(payload->sid, resources, reply);
+        goto exit;
+    }
+    entry = m_registry->Find(payload->sid);
+    if (entry && entry->m_bus)
+    {
+        std::unordered_map<std::string, DeviceFingerprint>::iterator device =
+                m_deviceFingerprints.find(payload->sid);
+        if ((device == m_deviceFingerprints.end()) || (device->second.m_resources == resources))
+        {
+            AddFingerprint(payload->sid, resources, reply);
+            goto exit;
+        }
+        /* Only this device is discovered again */
+        LOG(LOG_INFO, "[%p] Resources of %s changed", this, payload->sid);
+        Destroy(payload->sid);
+        DiscoverChurn();
+    }
+    if (HasSeenBefore(payload))
+    {
+        goto exit;
+    }
+    context = new DiscoverContext(this, origin, payload);
+    if (!context)
+    {
+        goto exit;
+    }
+    context->m_resources = resources;
+    context->m_reply = reply;
+    result = ContinueDiscovery(context, OC_RSRVD_DEVICE_URI,
+            context->GetDevAddrs(OC_RSRVD_DEVICE_URI), Bridge::GetDeviceCB);
+    if (result == OC_STACK_OK)
+    {
+        context = NULL;
+    }
+
+exit:
+    delete context;
+}
+
+/*
+ * Notifications of the /oic/res of a bridged device.  A notification is sent when the resources
+ * of the device change, including when a bridge creates resources for newly bridged devices, so
+ * these arrive without waiting for the next multicast discovery.
+ */
+OCStackApplicationResult Bridge::ObserveResCB(void *ctx, OCDoHandle handle,
+        OCClientResponse *response)
+{
+    Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
+    LOG(LOG_INFO, "[%p]", thiz);
+
+    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    std::map<std::string, ResObserve>::iterator it;
+    for (it = thiz->m_resObserves.begin(); it != thiz->m_resObserves.end(); ++it)
+    {
+        if (it->second.m_handle == handle)
         {
-            goto next;
+            break;
         }
-        context = new DiscoverContext(thiz, response->devAddr, payload);
-        if (!context)
+    }
+    if (it == thiz->m_resObserves.end())
+    {
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+    if (!response || (response->result > OC_STACK_RESOURCE_CHANGED))
+    {
+        /* No longer reachable, presence will decide whether the device is gone */
+        LOG(LOG_INFO, "[%p] Observe of %s/oic/res ended", thiz, it->first.c_str());
+        thiz->m_resObserves.erase(it);
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+    bool isNotification = it->second.m_registered;
+    it->second.m_registered = true;
+    if (response->payload && (response->payload->type == PAYLOAD_TYPE_DISCOVERY))
+    {
+        /* May destroy the device and with it the observation, it is not used after this */
+        OCDiscoveryPayload *payload;
+        for (payload = (OCDiscoveryPayload *) response->payload; payload; payload = payload->next)
         {
-            goto next;
+            thiz->Discovered(response->devAddr, payload);
         }
-        result = thiz->ContinueDiscovery(context, OC_RSRVD_DEVICE_URI,
-                context->GetDevAddrs(OC_RSRVD_DEVICE_URI), Bridge::GetDeviceCB);
-        if (result == OC_STACK_OK)
+        if (isNotification)
         {
-            context = NULL;
+            /* Only the notifications after the registration reply are changes */
+            thiz->DiscoverChurn();
         }
-    next:
-        delete context;
     }
-
-exit:
     return OC_STACK_KEEP_TRANSACTION;
 }
 
+/* Called with m_mutex held. */
+void Bridge::AddFingerprint(const char *di, uint64_t resources, uint64_t reply)
+{
+    DeviceFingerprint &device = m_deviceFingerprints[di];
+    if (device.m_resources != resources)
+    {
+        for (uint64_t fingerprint : device.m_replies)
+        {
+            m_fingerprints.erase(fingerprint);
+        }
+        device.m_replies.clear();
+        device.m_resources = resources;
+    }
+    device.m_replies.push_back(reply);
+    m_fingerprints.insert(reply);
+}
+
+/* Called with m_mutex held. */
+void Bridge::RemoveFingerprints(const char *di)
+{
+    std::unordered_map<std::string, DeviceFingerprint>::iterator device =
+            m_deviceFingerprints.find(di);
+    if (device != m_deviceFingerprints.end())
+    {
+        for (uint64_t fingerprint : device->second.m_replies)
+        {
+            m_fingerprints.erase(fingerprint);
+        }
+        m_deviceFingerprints.erase(device);
+    }
+}
+
+/* Called with m_mutex held. */
+void Bridge::ObserveRes(DiscoverContext *context)
+{
+    if (m_resObserves.find(context->m_device.m_di) != m_resObserves.end())
+    {
+        return;
+    }
+    ResObserve observe;
+    OCStackResult result = DoResource(&observe.m_handle, OC_REST_OBSERVE,
+            OC_RSRVD_WELL_KNOWN_URI, &context->m_origin, Bridge::ObserveResCB);
+    if (result == OC_STACK_OK)
+    {
+        observe.m_registered = false;
+        m_resObserves[context->m_device.m_di] = observe;
+    }
+}
+
+/*
+ * Called with m_mutex held.  Shortens the discovery period to the minimum and brings forward
+ * the next discovery if it is further away than that.
+ */
+void Bridge::DiscoverChurn()
+{
+    m_discoverChurn = true;
+    uint64_t tick = GetMonotonicMs() + DISCOVER_PERIOD_SECS * 1000;
+    if (m_discoverNextTick > tick)
+    {
+        m_discoverNextTick = tick;
+        Wake();
+    }
+}
+
+/*
+ * Called with m_mutex held at the start of each discovery.  The period doubles each time no
+ * device appeared, changed, or disappeared during the last one, up to DISCOVER_PERIOD_MAX_SECS,
+ * and drops back to DISCOVER_PERIOD_SECS otherwise.
+ */
+void Bridge::UpdateDiscoverPeriod()
+{
+    uint64_t periodMs = DISCOVER_PERIOD_SECS * 1000;
+    if (!m_discoverChurn)
+    {
+        periodMs = std::min(m_discoverPeriodMs * 2, (uint64_t) DISCOVER_PERIOD_MAX_SECS * 1000);
+    }
+    m_discoverChurn = false;
+    if (periodMs != m_discoverPeriodMs)
+    {
+        LOG(LOG_INFO, "[%p] Discover period %" PRIu64 " ms", this, periodMs);
+        m_discoverPeriodMs = periodMs;
+        for (Registry::Iterator it = m_registry->Begin(); it != m_registry->End(); ++it)
+        {
+            if (it->second->m_presence)
+            {
+                it->second->m_presence->SetPeriod(m_discoverPeriodMs / 1000);
+            }
+        }
+    }
+}
+
 OCStackApplicationResult Bridge::GetDeviceCB(void *ctx, OCDoHandle handle,
         OCClientResponse *response)
 {
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
-    OCStackResult result;
+    thiz->Dispatch(handle, response, Bridge::ProcessDevice);
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+void Bridge::ProcessDevice(Bridge *thiz, DiscoverContext *&context, OCRepPayload *payload,
+        const OCDevAddr *devAddr)
+{
+    (void) devAddr;
     bool isVirtual;
     char *piid = NULL;
-    DiscoverContext *context;
-    OCRepPayload *payload;
-    thiz->GetContextAndRepPayload(handle, response, &context, &payload);
-    if (!context || !payload)
+    if (!payload)
     {
         goto exit;
     }
     OCRepPayloadGetPropString(payload, OC_RSRVD_PROTOCOL_INDEPENDENT_ID, &piid);
     isVirtual = context->m_device.IsVirtual();
-    switch (thiz->GetSeenState(piid))
     {
-        case NOT_SEEN:
-            context->m_bus = VirtualBusAttachment::Create(context->m_device.m_di.c_str(), piid,
-                    isVirtual);
-            break;
-        case SEEN_NATIVE:
-            /* Do nothing */
+        std::lock_guard<std::mutex> lock(thiz->m_mutex);
+        if (context->m_cancelled)
+        {
             goto exit;
-        case SEEN_VIRTUAL:
-            if (isVirtual)
-            {
+        }
+        switch (thiz->GetSeenState(piid))
+        {
+            case NOT_SEEN:
+                context->m_bus = VirtualBusAttachment::Create(context->m_device.m_di.c_str(),
+                        piid, isVirtual);
+                break;
+            case SEEN_NATIVE:
                 /* Do nothing */
-            }
-            else
-            {
-                /* Delay creating virtual objects from a virtual device */
-                LOG(LOG_INFO, "[%p] Delaying creation of virtual objects from a virtual device",
-                        thiz);
-                thiz->m_tasks.push_back(new DiscoverTask(time(NULL) + 10, piid, payload, context));
-                context = NULL;
-            }
-            goto exit;
+                thiz->AddFingerprint(context->m_device.m_di.c_str(), context->m_resources,
+                        context->m_reply);
+                goto exit;
+            case SEEN_VIRTUAL:
+                if (isVirtual)
+                {
+                    /* Do nothing */
+                    thiz->AddFingerprint(context->m_device.m_di.c_str(), context->m_resources,
+                            context->m_reply);
+                }
+                else
+                {
+                    /* Delay creating virtual objects from a virtual device */
+                    LOG(LOG_INFO, "[%p] Delaying creation of virtual objects from a virtual device",
+                            thiz);
+                    thiz->m_processing.erase(thiz->m_processing.find(context));
+                    --context->m_refs;
+                    thiz->m_tasks->Schedule(new DiscoverTask(piid, payload, context),
+                            GetMonotonicMs() + 10 * 1000);
+                    thiz->Wake();
+                    context = NULL;
+                }
+                goto exit;
+        }
     }
     if (!context->m_bus)
     {
-        goto exit;
-    }
-    context->m_bus->SetAboutData(OC_RSRVD_DEVICE_URI, payload);
-    result = thiz->ContinueDiscovery(context, OC_RSRVD_PLATFORM_URI,
-            context->GetDevAddrs(OC_RSRVD_PLATFORM_URI), Bridge::GetPlatformCB);
-    if (result == OC_STACK_OK)
-    {
-        context = NULL;
+        goto exit;
     }
+    context->m_bus->SetAboutData(OC_RSRVD_DEVICE_URI, payload);
+    thiz->ResumeDiscovery(context, OC_RSRVD_PLATFORM_URI,
+            context->GetDevAddrs(OC_RSRVD_PLATFORM_URI), Bridge::GetPlatformCB);
 
 exit:
     OICFree(piid);
-    delete context;
-    thiz->m_discovered.erase(handle);
-    return OC_STACK_DELETE_TRANSACTION;
 }
 
 OCStackApplicationResult Bridge::GetPlatformCB(void *ctx, OCDoHandle handle,
@@ -1250,46 +1847,45 @@ OCStackApplicationResult Bridge::GetPlatformCB(void *ctx, OCDoHandle handle,
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    thiz->Dispatch(handle, response, Bridge::ProcessPlatform);
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+void Bridge::ProcessPlatform(Bridge *thiz, DiscoverContext *&context, OCRepPayload *payload,
+        const OCDevAddr *devAddr)
+{
+    (void) devAddr;
     Resource *resource;
-    DiscoverContext *context;
-    OCRepPayload *payload;
-    thiz->GetContextAndRepPayload(handle, response, &context, &payload);
-    if (!context || !payload)
+    char *sv = NULL;
+    std::string data;
+    if (!payload)
     {
-        goto exit;
+        return;
     }
     context->m_bus->SetAboutData(OC_RSRVD_PLATFORM_URI, payload);
+    if (OCRepPayloadGetPropString(payload, OC_RSRVD_SOFTWARE_VERSION, &sv))
+    {
+        context->m_softwareVersion = sv;
+        OICFree(sv);
+    }
     resource = context->m_device.GetResourceType(OC_RSRVD_RESOURCE_TYPE_INTROSPECTION);
-    OCStackResult result;
-    if (resource)
+    if (resource && !context->m_softwareVersion.empty() &&
+            thiz->m_introspectionCache->Get(context->m_device.m_di, context->m_softwareVersion,
+                    data) &&
+            (thiz->ParseIntrospectionData(context, data.c_str()) == OC_STACK_OK))
     {
-        result = thiz->ContinueDiscovery(context, resource->m_uri.c_str(),
-                resource->m_addrs, Bridge::GetIntrospectionCB);
+        LOG(LOG_INFO, "[%p] Using cached introspection data", thiz);
     }
-    else
+    else if (resource)
     {
-        LOG(LOG_INFO, "[%p] Missing introspection resource", thiz);
-        context->m_paths = OCRepPayloadCreate();
-        context->m_definitions = OCRepPayloadCreate();
-        if (!context->m_paths || !context->m_definitions)
-        {
-            LOG(LOG_ERR, "Failed to create payload");
-            goto exit;
-        }
-        context->m_it = context->Begin();
-        result = thiz->ContinueDiscovery(context, context->m_it.GetUri().c_str(),
-                context->m_it.GetDevAddrs(), Bridge::GetCB);
+        thiz->ResumeDiscovery(context, resource->m_uri.c_str(), resource->m_addrs,
+                Bridge::GetIntrospectionCB);
     }
-    if (result == OC_STACK_OK)
+    else
     {
-        context = NULL;
+        LOG(LOG_INFO, "[%p] Missing introspection resource", thiz);
+        thiz->StartProbes(context);
     }
-
-exit:
-    delete context;
-    thiz->m_discovered.erase(handle);
-    return OC_STACK_DELETE_TRANSACTION;
 }
 
 OCStackApplicationResult Bridge::GetIntrospectionCB(void *ctx, OCDoHandle handle,
@@ -1298,17 +1894,20 @@ OCStackApplicationResult Bridge::GetIntrospectionCB(void *ctx, OCDoHandle handle
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    thiz->Dispatch(handle, response, Bridge::ProcessIntrospection);
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+void Bridge::ProcessIntrospection(Bridge *thiz, DiscoverContext *&context,
+        OCRepPayload *payload, const OCDevAddr *devAddr)
+{
     OCStackResult result = OC_STACK_ERROR;
     char *url = NULL;
     char *protocol = NULL;
     size_t dim[MAX_REP_ARRAY_DEPTH] = { 0 };
     size_t dimTotal;
     OCRepPayload **urlInfo = NULL;
-    DiscoverContext *context;
-    OCRepPayload *payload;
-    thiz->GetContextAndRepPayload(handle, response, &context, &payload);
-    if (!context || !payload)
+    if (!payload)
     {
         goto exit;
     }
@@ -1332,11 +1931,11 @@ OCStackApplicationResult Bridge::GetIntrospectionCB(void *ctx, OCDoHandle handle
            )
         {
             LOG(LOG_INFO, "[%p] protocol=%s,url=%s", thiz, protocol, url);
-            OCStackResult result = thiz->ContinueDiscovery(context, url, &response->devAddr,
+            std::vector<OCDevAddr> addrs = { *devAddr };
+            OCStackResult result = thiz->ResumeDiscovery(context, url, addrs,
                     Bridge::GetIntrospectionDataCB);
             if (result == OC_STACK_OK)
             {
-                context = NULL;
                 break;
             }
         }
@@ -1349,20 +1948,7 @@ OCStackApplicationResult Bridge::GetIntrospectionCB(void *ctx, OCDoHandle handle
 exit:
     if (context && (result != OC_STACK_OK))
     {
-        context->m_paths = OCRepPayloadCreate();
-        context->m_definitions = OCRepPayloadCreate();
-        if (!context->m_paths || !context->m_definitions)
-        {
-            LOG(LOG_ERR, "Failed to create payload");
-            goto exit;
-        }
-        context->m_it = context->Begin();
-        result = thiz->ContinueDiscovery(context, context->m_it.GetUri().c_str(),
-                context->m_it.GetDevAddrs(), Bridge::GetCB);
-        if (result == OC_STACK_OK)
-        {
-            context = NULL;
-        }
+        thiz->StartProbes(context);
     }
     OICFree(url);
     OICFree(protocol);
@@ -1375,9 +1961,6 @@ exit:
         }
     }
     OICFree(urlInfo);
-    delete context;
-    thiz->m_discovered.erase(handle);
-    return OC_STACK_DELETE_TRANSACTION;
 }
 
 OCStackApplicationResult Bridge::GetIntrospectionDataCB(void *ctx, OCDoHandle handle,
@@ -1386,15 +1969,18 @@ OCStackApplicationResult Bridge::GetIntrospectionDataCB(void *ctx, OCDoHandle ha
     Bridge *thiz = reinterpret_cast<Bridge *>(ctx);
     LOG(LOG_INFO, "[%p]", thiz);
 
-    std::lock_guard<std::mutex> lock(thiz->m_mutex);
+    thiz->Dispatch(handle, response, Bridge::ProcessIntrospectionData);
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+void Bridge::ProcessIntrospectionData(Bridge *thiz, DiscoverContext *&context,
+        OCRepPayload *payload, const OCDevAddr *devAddr)
+{
+    (void) devAddr;
     OCStackResult result = OC_STACK_ERROR;
     char *data = NULL;
-    OCPayload *outPayload = NULL;
-    DiscoverContext *context;
-    OCRepPayload *payload;
 
-    thiz->GetContextAndRepPayload(handle, response, &context, &payload);
-    if (!context || !payload)
+    if (!payload)
     {
         goto exit;
     }
@@ -1402,40 +1988,36 @@ OCStackApplicationResult Bridge::GetIntrospectionDataCB(void *ctx, OCDoHandle ha
     {
         goto exit;
     }
-    result = ParsePayload(&outPayload, OC_FORMAT_JSON, PAYLOAD_TYPE_REPRESENTATION,
-            (const uint8_t*) data, strlen(data));
-    if (result != OC_STACK_OK)
+    result = thiz->ParseIntrospectionData(context, data);
+    if ((result == OC_STACK_OK) && !context->m_softwareVersion.empty())
     {
-        goto exit;
+        thiz->m_introspectionCache->Put(context->m_device.m_di, context->m_softwareVersion,
+                data);
+        std::lock_guard<std::mutex> lock(thiz->m_mutex);
+        thiz->ScheduleSaveCache();
     }
-    OICFree(data);
-    data = NULL;
-
-    thiz->ParseIntrospectionPayload(context, (OCRepPayload *) outPayload);
 
 exit:
     if (context && (result != OC_STACK_OK))
     {
-        context->m_paths = OCRepPayloadCreate();
-        context->m_definitions = OCRepPayloadCreate();
-        if (!context->m_paths || !context->m_definitions)
-        {
-            LOG(LOG_ERR, "Failed to create payload");
-            goto exit;
-        }
-        context->m_it = context->Begin();
-        result = thiz->ContinueDiscovery(context, context->m_it.GetUri().c_str(),
-                context->m_it.GetDevAddrs(), Bridge::GetCB);
-        if (result == OC_STACK_OK)
-        {
-            context = NULL;
-        }
+        thiz->StartProbes(context);
     }
-    OCPayloadDestroy(outPayload);
     OICFree(data);
-    delete context;
-    thiz->m_discovered.erase(handle);
-    return OC_STACK_DELETE_TRANSACTION;
+}
+
+/* Called from a DiscoverWork with the JSON introspection data of the device. */
+OCStackResult Bridge::ParseIntrospectionData(DiscoverContext *context, const char *data)
+{
+    OCPayload *outPayload = NULL;
+    OCStackResult result = ParsePayload(&outPayload, OC_FORMAT_JSON, PAYLOAD_TYPE_REPRESENTATION,
+            (const uint8_t*) data, strlen(data));
+    if (result != OC_STACK_OK)
+    {
+        return result;
+    }
+    ParseIntrospectionPayload(context, (OCRepPayload *) outPayload);
+    OCPayloadDestroy(outPayload);
+    return OC_STACK_OK;
 }
 
 static bool SetPropertiesSchema(OCRepPayload *parent, OCRepPayload *obj);
@@ -1601,6 +2183,67 @@ exit:
     return success;
 }
 
+/*
+ * Called from a DiscoverWork when the device has no usable introspection resource.  Each
+ * (resource, rt) pair is probed with a GET, with up to m_probeWindow probes outstanding.  The
+ * definitions are inferred from the replies once all of them have arrived.
+ */
+void Bridge::StartProbes(DiscoverContext *&context)
+{
+    context->m_paths = OCRepPayloadCreate();
+    context->m_definitions = OCRepPayloadCreate();
+    if (!context->m_paths || !context->m_definitions)
+    {
+        LOG(LOG_ERR, "Failed to create payload");
+        return;
+    }
+    for (DiscoverContext::Iterator it = context->Begin(); it != context->End(); ++it)
+    {
+        context->m_probes.push_back(it);
+    }
+    context->m_replies.assign(context->m_probes.size(), NULL);
+    context->m_nextProbe = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (context->m_cancelled)
+        {
+            return;
+        }
+        IssueProbes(context);
+        if (!context->m_probeHandles.empty())
+        {
+            /* The outstanding probes keep context alive */
+            m_processing.erase(m_processing.find(context));
+            --context->m_refs;
+            context = NULL;
+            return;
+        }
+    }
+    ProcessProbes(this, context, NULL, NULL);
+}
+
+/* Called with m_mutex held. */
+void Bridge::IssueProbes(DiscoverContext *context)
+{
+    while ((context->m_nextProbe < context->m_probes.size()) &&
+            (context->m_probeHandles.size() < m_probeWindow))
+    {
+        size_t i = context->m_nextProbe++;
+        std::string uri = context->m_probes[i].GetUri();
+        OCDoHandle cbHandle;
+        OCStackResult result = DoResource(&cbHandle, OC_REST_GET, uri.c_str(),
+                context->m_probes[i].GetDevAddrs(), Bridge::GetCB);
+        if (result == OC_STACK_OK)
+        {
+            /* A failed probe is treated the same as a failed GET, as a reply with no payload */
+            LOG(LOG_INFO, "Get(%s)", uri.c_str());
+            m_discovered[cbHandle] = context;
+            ++context->m_refs;
+            context->m_probeHandles[cbHandle] = i;
+        }
+    }
+}
+
 OCStackApplicationResult Bridge::GetCB(void *ctx, OCDoHandle handle,
         OCClientResponse *response)
 {
@@ -1610,6 +2253,77 @@ OCStackApplicationResult Bridge::GetCB(void *ctx, OCDoHandle handle,
     std::lock_guard<std::mutex> lock(thiz->m_mutex);
     DiscoverContext *context;
     OCRepPayload *payload;
+    std::map<OCDoHandle, size_t>::iterator probe;
+    thiz->GetContextAndRepPayload(handle, response, &context, &payload);
+    thiz->m_discovered.erase(handle);
+    if (!context)
+    {
+        goto exit;
+    }
+    probe = context->m_probeHandles.find(handle);
+    if (probe != context->m_probeHandles.end())
+    {
+        if (payload)
+        {
+            context->m_replies[probe->second] = OCRepPayloadClone(payload);
+        }
+        context->m_probeHandles.erase(probe);
+    }
+    thiz->IssueProbes(context);
+    if (context->m_probeHandles.empty() && thiz->m_executor)
+    {
+        /* All replies are in, the reference held by handle moves to the DiscoverWork */
+        thiz->m_processing.insert(context);
+        thiz->m_executor->Post(context->m_device.m_di, new DiscoverWork(thiz,
+                Bridge::ProcessProbes, context, NULL, OCDevAddr()));
+        context = NULL;
+    }
+    if (context && (--context->m_refs == 0))
+    {
+        delete context;
+    }
+
+exit:
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+void Bridge::ProcessProbes(Bridge *thiz, DiscoverContext *&context, OCRepPayload *payload,
+        const OCDevAddr *devAddr)
+{
+    (void) payload;
+    (void) devAddr;
+    OCRepPayload *outPayload = NULL;
+    /* Merge in probe order so that the result does not depend on the order of the replies */
+    for (size_t i = 0; i < context->m_probes.size(); ++i)
+    {
+        context->m_it = context->m_probes[i];
+        AddProbeDefinition(context, context->m_replies[i]);
+    }
+    outPayload = OCRepPayloadCreate();
+    if (!outPayload)
+    {
+        LOG(LOG_ERR, "Failed to create payload");
+        goto exit;
+    }
+    if (!OCRepPayloadSetPropObjectAsOwner(outPayload, "paths", context->m_paths))
+    {
+        goto exit;
+    }
+    context->m_paths = NULL;
+    if (!OCRepPayloadSetPropObjectAsOwner(outPayload, "definitions", context->m_definitions))
+    {
+        goto exit;
+    }
+    context->m_definitions = NULL;
+    thiz->ParseIntrospectionPayload(context, outPayload);
+
+exit:
+    OCRepPayloadDestroy(outPayload);
+}
+
+/* Adds the definition and path inferred from the reply to the probe of context->m_it. */
+void Bridge::AddProbeDefinition(DiscoverContext *context, OCRepPayload *payload)
+{
     bool found;
     OCRepPayload *definition = NULL;
     OCRepPayload *properties = NULL;
@@ -1631,12 +2345,6 @@ OCStackApplicationResult Bridge::GetCB(void *ctx, OCDoHandle handle,
     size_t oneOfDim[MAX_REP_ARRAY_DEPTH] = { 0 };
     OCRepPayload **oneOf = NULL;
     std::string ref;
-    OCRepPayload *outPayload = NULL;
-    thiz->GetContextAndRepPayload(handle, response, &context, &payload);
-    if (!context)
-    {
-        goto exit;
-    }
 
     found = false;
     for (OCRepPayloadValue *d = context->m_definitions->values; d; d = d->next)
@@ -1976,38 +2684,7 @@ OCStackApplicationResult Bridge::GetCB(void *ctx, OCDoHandle handle,
         path = NULL;
     }
 
-    if (++context->m_it != context->End())
-    {
-        OCStackResult result = thiz->ContinueDiscovery(context, context->m_it.GetUri().c_str(),
-                context->m_it.GetDevAddrs(), Bridge::GetCB);
-        if (result == OC_STACK_OK)
-        {
-            context = NULL;
-        }
-    }
-    else
-    {
-        outPayload = OCRepPayloadCreate();
-        if (!outPayload)
-        {
-            LOG(LOG_ERR, "Failed to create payload");
-            goto exit;
-        }
-        if (!OCRepPayloadSetPropObjectAsOwner(outPayload, "paths", context->m_paths))
-        {
-            goto exit;
-        }
-        context->m_paths = NULL;
-        if (!OCRepPayloadSetPropObjectAsOwner(outPayload, "definitions", context->m_definitions))
-        {
-            goto exit;
-        }
-        context->m_definitions = NULL;
-        thiz->ParseIntrospectionPayload(context, outPayload);
-    }
-
 exit:
-    OCRepPayloadDestroy(outPayload);
     if (oneOf)
     {
         dimTotal = calcDimTotal(oneOfDim);
@@ -2054,9 +2731,6 @@ exit:
     OCRepPayloadDestroy(rt);
     OCRepPayloadDestroy(properties);
     OCRepPayloadDestroy(definition);
-    thiz->m_discovered.erase(handle);
-    delete context;
-    return OC_STACK_DELETE_TRANSACTION;
 }
 
 typedef std::pair<std::string, std::string> Annotation;
@@ -2345,6 +3019,7 @@ static void AddInterface(VirtualBusObject *obj, OCRepPayload *schema,
     }
 }
 
+/* Called from a DiscoverWork, m_mutex is only held to publish the results. */
 void Bridge::ParseIntrospectionPayload(DiscoverContext *context, OCRepPayload *payload)
 {
     OCRepPayload *definitions = NULL;
@@ -2672,15 +3347,27 @@ void Bridge::ParseIntrospectionPayload(DiscoverContext *context, OCRepPayload *p
         LOG(LOG_ERR, "new OCPresence() failed");
         goto exit;
     }
-    m_presence.push_back(presence);
-    status = context->m_bus->Announce();
-    if (status != ER_OK)
     {
-        LOG(LOG_ERR, "Announce() failed - %s", QCC_StatusText(status));
-        goto exit;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (context->m_cancelled)
+        {
+            LOG(LOG_INFO, "[%p] Discovery of %s cancelled", this, context->m_device.m_di.c_str());
+            delete presence;
+            goto exit;
+        }
+        presence->SetPeriod(m_discoverPeriodMs / 1000);
+        m_registry->AddPresence(context->m_device.m_di, presence);
+        status = context->m_bus->Announce();
+        if (status != ER_OK)
+        {
+            LOG(LOG_ERR, "Announce() failed - %s", QCC_StatusText(status));
+            goto exit;
+        }
+        m_registry->AddBus(context->m_device.m_di, context->m_bus);
+        context->m_bus = NULL; /* context->m_bus now belongs to m_registry */
+        ObserveRes(context);
+        DiscoverChurn();
     }
-    m_virtualBusAttachments.push_back(context->m_bus);
-    context->m_bus = NULL; /* context->m_bus now belongs to thiz */
 
 exit:
     OCRepPayloadDestroy(paths);
@@ -2710,6 +3397,12 @@ bool Bridge::PostSecureMode(OCEntityHandlerRequest *request, bool &hasChanged)
     }
     hasChanged = (m_secureMode != secureMode);
     m_secureMode = secureMode;
+    if (hasChanged)
+    {
+        /* Which devices are translatable depends on the secure mode */
+        m_fingerprints.clear();
+        m_deviceFingerprints.clear();
+    }
     return true;
 }
 
@@ -2816,17 +3509,21 @@ Bridge::SeenState Bridge::GetSeenState(const char *piid)
                 break;
             }
         }
-        if (!bus)
+        for (std::multiset<DiscoverContext *>::iterator it = m_processing.begin();
+             !bus && it != m_processing.end(); ++it)
         {
-            for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
+            DiscoverContext *discoverContext = *it;
+            if (discoverContext->m_bus &&
+                    (discoverContext->m_bus->GetProtocolIndependentId() == piid))
             {
-                if (busAttachment->GetProtocolIndependentId() == piid)
-                {
-                    bus = busAttachment;
-                    break;
-                }
+                bus = discoverContext->m_bus;
             }
         }
+        if (!bus)
+        {
+            Registry::Entry *entry = m_registry->FindByPiid(piid);
+            bus = entry ? entry->m_bus : NULL;
+        }
         if (bus)
         {
             state = bus->IsVirtual() ? SEEN_VIRTUAL : SEEN_NATIVE;
@@ -2866,20 +3563,9 @@ void Bridge::AnnouncedTask::Run(Bridge *thiz)
 void Bridge::DiscoverTask::Run(Bridge *thiz)
 {
     OCStackResult result = OC_STACK_ERROR;
-    DiscoverContext *context = NULL;
+    DiscoverContext *context = m_context;
     bool isVirtual;
-    for (std::map<OCDoHandle, DiscoverContext *>::iterator it = thiz->m_discovered.begin();
-         it != thiz->m_discovered.end(); ++it)
-    {
-        if (it->second == m_context)
-        {
-            context = it->second;
-        }
-    }
-    if (!context)
-    {
-        goto exit;
-    }
+    m_context = NULL;
 
     isVirtual = context->m_device.IsVirtual();
     switch (thiz->GetSeenState(m_piid.c_str()))
@@ -2890,11 +3576,15 @@ void Bridge::DiscoverTask::Run(Bridge *thiz)
             break;
         case SEEN_NATIVE:
             /* Do nothing */
+            thiz->AddFingerprint(context->m_device.m_di.c_str(), context->m_resources,
+                    context->m_reply);
             goto exit;
         case SEEN_VIRTUAL:
             if (isVirtual)
             {
                 /* Do nothing */
+                thiz->AddFingerprint(context->m_device.m_di.c_str(), context->m_resources,
+                        context->m_reply);
             }
             else
             {
@@ -2939,13 +3629,10 @@ void Bridge::DestroyPiid(const char *piid)
     }
     if (di.empty())
     {
-        for (VirtualBusAttachment *busAttachment : m_virtualBusAttachments)
+        Registry::Entry *entry = m_registry->FindByPiid(piid);
+        if (entry)
         {
-            if (busAttachment->GetProtocolIndependentId() == piid)
-            {
-                di = busAttachment->GetDi();
-                break;
-            }
+            di = entry->m_id;
         }
     }
     if (!di.empty())
@@ -2959,15 +3646,75 @@ void Bridge::RDPublish()
     LOG(LOG_INFO, "[%p]", this);
 
     std::lock_guard<std::mutex> lock(m_mutex);
-    if (m_rdPublishTask)
+    ScheduleRDPublish();
+    /* The resources may have been created from newly cached introspection data. */
+    ScheduleSaveCache();
+}
+
+void Bridge::ScheduleNotify(const char *id, const char *path, uint64_t tick)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_tasks)
     {
-        /* Delay the pending publication to give time for multiple resources to be created. */
-        m_rdPublishTask->m_tick = time(NULL) + 1;
+        return;
     }
-    else
+    m_tasks->Schedule(new NotifyTask(id, path), tick);
+    Wake();
+}
+
+/* Called with m_mutex held. */
+void Bridge::ScheduleRDPublish()
+{
+    /* Delay any pending publication to give time for multiple resources to be created. */
+    if (!m_rdPublishTask)
+    {
+        m_rdPublishTask = new RDPublishTask();
+    }
+    m_tasks->Schedule(m_rdPublishTask, GetMonotonicMs() + 1000);
+    Wake();
+}
+
+/* Called with m_mutex held. */
+void Bridge::ScheduleSaveCache()
+{
+    /* Batch the changes made while discovering many devices into one write. */
+    if (!m_saveCacheTask)
+    {
+        m_saveCacheTask = new SaveCacheTask();
+        m_tasks->Schedule(m_saveCacheTask, GetMonotonicMs() + 5 * 1000);
+        Wake();
+    }
+}
+
+/* Called with m_mutex held. */
+void Bridge::SaveCacheTask::Run(Bridge *thiz)
+{
+    OCPersistentStorage *ps = OCGetPersistentStorageHandler();
+    if (ps)
+    {
+        thiz->m_introspectionCache->Save(ps);
+    }
+    thiz->m_saveCacheTask = NULL;
+}
+
+/* Called with m_mutex held. */
+void Bridge::NotifyTask::Run(Bridge *thiz)
+{
+    /* The resource may have been destroyed since the task was scheduled */
+    Registry::Entry *entry = thiz->m_registry->Find(m_id);
+    if (!entry)
+    {
+        return;
+    }
+    std::map<std::string, VirtualResource *>::iterator it = entry->m_resources.find(m_path);
+    if (it == entry->m_resources.end())
+    {
+        return;
+    }
+    uint64_t tick = it->second->FlushNotifications(GetMonotonicMs());
+    if (tick != TaskQueue::NEVER)
     {
-        m_rdPublishTask = new RDPublishTask(time(NULL) + 1);
-        m_tasks.push_back(m_rdPublishTask);
+        thiz->m_tasks->Schedule(new NotifyTask(m_id.c_str(), m_path.c_str()), tick);
     }
 }
 
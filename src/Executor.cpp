@@ -0,0 +1,137 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "Executor.h"
+
+#include <functional>
+
+Executor::Executor(size_t numThreads)
+    : m_done(false)
+{
+    if (numThreads == 0)
+    {
+        numThreads = 1;
+    }
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        m_workers.push_back(new Worker());
+    }
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        m_workers[i]->m_thread = std::thread(Executor::Run, this, i);
+    }
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done = true;
+        m_cond.notify_all();
+    }
+    for (Worker *worker : m_workers)
+    {
+        worker->m_thread.join();
+        delete worker;
+    }
+    for (auto &s : m_strands)
+    {
+        for (Work *work : s.second->m_work)
+        {
+            delete work;
+        }
+        delete s.second;
+    }
+}
+
+void Executor::Post(const std::string &key, Work *work)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_done)
+    {
+        delete work;
+        return;
+    }
+    Strand *&strand = m_strands[key];
+    if (strand)
+    {
+        /* The strand is already queued or running, it will pick up the work when it gets to it */
+        strand->m_work.push_back(work);
+        return;
+    }
+    strand = new Strand(key);
+    strand->m_work.push_back(work);
+    size_t i = std::hash<std::string>()(key) % m_workers.size();
+    m_workers[i]->m_ready.push_back(strand);
+    m_cond.notify_one();
+}
+
+/* Called with m_mutex held. */
+Executor::Strand *Executor::Take(size_t i)
+{
+    Strand *strand = NULL;
+    if (!m_workers[i]->m_ready.empty())
+    {
+        strand = m_workers[i]->m_ready.front();
+        m_workers[i]->m_ready.pop_front();
+        return strand;
+    }
+    for (size_t j = 1; j < m_workers.size(); ++j)
+    {
+        Worker *victim = m_workers[(i + j) % m_workers.size()];
+        if (!victim->m_ready.empty())
+        {
+            strand = victim->m_ready.back();
+            victim->m_ready.pop_back();
+            return strand;
+        }
+    }
+    return NULL;
+}
+
+void Executor::Run(Executor *thiz, size_t i)
+{
+    std::unique_lock<std::mutex> lock(thiz->m_mutex);
+    while (!thiz->m_done)
+    {
+        Strand *strand = thiz->Take(i);
+        if (!strand)
+        {
+            thiz->m_cond.wait(lock);
+            continue;
+        }
+        Work *work = strand->m_work.front();
+        strand->m_work.pop_front();
+        lock.unlock();
+        work->Run();
+        delete work;
+        lock.lock();
+        if (strand->m_work.empty())
+        {
+            thiz->m_strands.erase(strand->m_key);
+            delete strand;
+        }
+        else
+        {
+            /* One item per turn so that a busy strand does not starve the others */
+            thiz->m_workers[i]->m_ready.push_back(strand);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _EXECUTOR_H
+#define _EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * A fixed pool of worker threads that runs work in strands.  Work posted with the same key runs
+ * one item at a time in the order it was posted; work posted with different keys may run in
+ * parallel.  Each key is sharded onto a home worker, and idle workers steal ready strands from
+ * the other workers so that a burst of work for one shard does not leave the rest of the pool
+ * idle.
+ */
+class Executor
+{
+    public:
+        class Work
+        {
+            public:
+                virtual ~Work() { }
+                virtual void Run() = 0;
+        };
+
+        Executor(size_t numThreads);
+        /* Waits for running work to finish, work that has not yet started is deleted. */
+        ~Executor();
+
+        /* Takes ownership of work. */
+        void Post(const std::string &key, Work *work);
+        size_t GetNumThreads() const { return m_workers.size(); }
+
+    private:
+        struct Strand
+        {
+            std::string m_key;
+            std::deque<Work *> m_work;
+            Strand(const std::string &key) : m_key(key) { }
+        };
+        struct Worker
+        {
+            std::deque<Strand *> m_ready;
+            std::thread m_thread;
+        };
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::unordered_map<std::string, Strand *> m_strands; /* key => strand queued or running */
+        std::vector<Worker *> m_workers;
+        bool m_done;
+
+        Executor(const Executor &);
+        Executor &operator=(const Executor &);
+        static void Run(Executor *thiz, size_t i);
+        Strand *Take(size_t i);
+};
+
+#endif
@@ -432,7 +432,7 @@ static OCStackResult Definitions(std::ostream &os, ajn::BusAttachment *bus,
                        << "\"properties\":{";
                     hasProps = true;
                 }
-                std::string propName = GetPropName(ifaces[i], props[j]->name);
+                std::string propName = GetPropName(ifaces[i], props[j]->name.c_str());
                 /*
                  * Annotations prior to v16.10.00 are not guaranteed to
                  * appear in the order they were specified, so are
@@ -501,7 +501,7 @@ static OCStackResult Definitions(std::ostream &os, ajn::BusAttachment *bus,
         ifaces[i]->GetMembers(members, numMembers);
         for (size_t j = 0; j < numMembers; ++j)
         {
-            std::string rt = GetResourceTypeName(ifaces[i], members[j]->name);
+            std::string rt = GetResourceTypeName(ifaces[i], members[j]->name.c_str());
             os << (comma++ ? ",\"" : "\"") << rt << "\":{"
                << "\"type\":\"object\","
                << "\"properties\":{";
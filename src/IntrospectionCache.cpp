@@ -0,0 +1,205 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "IntrospectionCache.h"
+
+#include "Plugin.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * The file is a header line followed by one record per entry:
+ *   id '\n' version '\n' hash '\n' size '\n' data '\n'
+ * where hash is the hex hash of data and size is the decimal length of data.
+ */
+static const char FILE_HEADER[] = "IntrospectionCache 1\n";
+
+uint64_t IntrospectionCache::Hash(const std::string &data)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        hash ^= (uint8_t) data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool GetLine(const std::string &s, size_t &pos, std::string &line)
+{
+    size_t end = s.find('\n', pos);
+    if (end == std::string::npos)
+    {
+        return false;
+    }
+    line = s.substr(pos, end - pos);
+    pos = end + 1;
+    return true;
+}
+
+bool IntrospectionCache::Parse(const std::string &s)
+{
+    size_t pos = sizeof(FILE_HEADER) - 1;
+    if (s.compare(0, pos, FILE_HEADER))
+    {
+        return false;
+    }
+    while (pos < s.size())
+    {
+        std::string id, version, hash, size;
+        if (!GetLine(s, pos, id) || !GetLine(s, pos, version) || !GetLine(s, pos, hash) ||
+                !GetLine(s, pos, size))
+        {
+            return false;
+        }
+        char *end;
+        unsigned long long n = strtoull(size.c_str(), &end, 10);
+        if (size.empty() || *end || (n > s.size() - pos) || (n == s.size() - pos) ||
+                (s[pos + n] != '\n'))
+        {
+            return false;
+        }
+        Entry entry;
+        entry.m_version = version;
+        entry.m_data = s.substr(pos, n);
+        pos += n + 1;
+        if (strtoull(hash.c_str(), &end, 16) != Hash(entry.m_data) || hash.empty() || *end)
+        {
+            LOG(LOG_INFO, "[%p] Dropping damaged entry %s", this, id.c_str());
+            m_dirty = true;
+            continue;
+        }
+        m_entries[id] = entry;
+    }
+    return true;
+}
+
+bool IntrospectionCache::Load(OCPersistentStorage *ps)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_dirty = false;
+    FILE *fp = ps->open(m_fileName.c_str(), "rb");
+    if (!fp)
+    {
+        /* Nothing cached yet */
+        return true;
+    }
+    std::string s;
+    char buf[4096];
+    size_t n;
+    while ((n = ps->read(buf, 1, sizeof(buf), fp)) > 0)
+    {
+        s.append(buf, n);
+    }
+    ps->close(fp);
+    if (!Parse(s))
+    {
+        LOG(LOG_ERR, "[%p] Failed to parse %s", this, m_fileName.c_str());
+        m_entries.clear();
+        m_dirty = true;
+        return false;
+    }
+    LOG(LOG_INFO, "[%p] Loaded %zu entries", this, m_entries.size());
+    return true;
+}
+
+bool IntrospectionCache::Save(OCPersistentStorage *ps)
+{
+    std::string s;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty)
+        {
+            return true;
+        }
+        s = FILE_HEADER;
+        for (auto &e : m_entries)
+        {
+            char hash[17];
+            snprintf(hash, sizeof(hash), "%016" PRIx64, Hash(e.second.m_data));
+            s += e.first + "\n" + e.second.m_version + "\n" + hash + "\n" +
+                    std::to_string(e.second.m_data.size()) + "\n" + e.second.m_data + "\n";
+        }
+        m_dirty = false;
+    }
+    bool success = false;
+    FILE *fp = ps->open(m_fileName.c_str(), "wb");
+    if (!fp)
+    {
+        LOG(LOG_ERR, "[%p] open %s failed", this, m_fileName.c_str());
+        goto exit;
+    }
+    if (ps->write(s.c_str(), 1, s.size(), fp) != s.size())
+    {
+        LOG(LOG_ERR, "[%p] write %s failed", this, m_fileName.c_str());
+        goto exit;
+    }
+    success = true;
+
+exit:
+    if (fp)
+    {
+        ps->close(fp);
+    }
+    if (!success)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dirty = true;
+    }
+    return success;
+}
+
+bool IntrospectionCache::Get(const std::string &id, const std::string &version,
+        std::string &data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, Entry>::iterator it = m_entries.find(id);
+    if (it == m_entries.end() || it->second.m_version != version)
+    {
+        return false;
+    }
+    data = it->second.m_data;
+    return true;
+}
+
+void IntrospectionCache::Put(const std::string &id, const std::string &version,
+        const std::string &data)
+{
+    if ((id.find('\n') != std::string::npos) || (version.find('\n') != std::string::npos))
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry &entry = m_entries[id];
+    if (entry.m_version == version && entry.m_data == data)
+    {
+        return;
+    }
+    entry.m_version = version;
+    entry.m_data = data;
+    m_dirty = true;
+}
+
+size_t IntrospectionCache::Size()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
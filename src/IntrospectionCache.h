@@ -0,0 +1,71 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _INTROSPECTIONCACHE_H
+#define _INTROSPECTIONCACHE_H
+
+#include "octypes.h"
+#include <inttypes.h>
+#include <map>
+#include <mutex>
+#include <string>
+
+/*
+ * Introspection data of bridged devices kept across restarts, the JSON introspection data for OC
+ * devices and the introspection XML of each object for AllJoyn devices.  Entries are keyed by an
+ * id that is stable across restarts (the di or piid) and are only returned when the version of
+ * the software of the device is unchanged.  A hash of the data is stored with each entry so that
+ * a damaged entry is dropped instead of being used.
+ *
+ * The cache is read and written through the OCPersistentStorage callbacks.  Thread-safe.
+ */
+class IntrospectionCache
+{
+    public:
+        IntrospectionCache(const char *fileName) : m_fileName(fileName), m_dirty(false) { }
+
+        /* Replaces the entries with the contents of the file, returns false if it is unreadable. */
+        bool Load(OCPersistentStorage *ps);
+        /* Writes the entries to the file if they changed since the last Load() or Save(). */
+        bool Save(OCPersistentStorage *ps);
+        bool Get(const std::string &id, const std::string &version, std::string &data);
+        void Put(const std::string &id, const std::string &version, const std::string &data);
+        size_t Size();
+
+        /* 64-bit FNV-1a */
+        static uint64_t Hash(const std::string &data);
+
+    private:
+        struct Entry
+        {
+            std::string m_version;
+            std::string m_data;
+        };
+        std::mutex m_mutex;
+        std::string m_fileName;
+        std::map<std::string, Entry> m_entries;
+        bool m_dirty;
+
+        IntrospectionCache(const IntrospectionCache &);
+        IntrospectionCache &operator=(const IntrospectionCache &);
+        bool Parse(const std::string &s);
+};
+
+#endif
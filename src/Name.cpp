@@ -20,106 +20,133 @@
 
 #include "Name.h"
 
-#include <sstream>
+#include <stdio.h>
+#include <string.h>
 
-std::string ToOCName(std::string ajName)
+static void AppendOCName(std::string &rt, const char *in)
 {
-    std::ostringstream rt;
-    rt << 'x';
-    rt << '.';
-    const char *in = ajName.c_str();
     while (*in)
     {
         if (isupper(*in))
         {
-            rt << '-';
-            rt << (char)(*in - 'A' + 'a');
+            rt += '-';
+            rt += (char)(*in - 'A' + 'a');
         }
         else if (*in == '_' && isalpha(*(in + 1)))
         {
-            rt << '-';
-            rt << '-';
+            rt += "--";
         }
         else if (*in == '_')
         {
-            rt << '-';
+            rt += '-';
         }
         else
         {
-            rt << *in;
+            rt += *in;
         }
         ++in;
     }
-    return rt.str();
 }
 
-std::string ToAJName(std::string ocName)
+/* Each AJ character expands to at most two OC characters */
+static std::string CreateOCName(size_t ajLength)
+{
+    std::string rt;
+    rt.reserve(2 + 2 * ajLength);
+    rt += "x.";
+    return rt;
+}
+
+std::string ToOCName(const std::string &ajName)
+{
+    std::string rt = CreateOCName(ajName.size());
+    AppendOCName(rt, ajName.c_str());
+    return rt;
+}
+
+static void AppendAJName(std::string &ajName, const char *in, const char *end)
 {
-    std::ostringstream ajName;
-    const char *in = ocName.c_str();
     if (*in == 'x' && *(in + 1) == '.')
     {
         ++in;
         ++in;
     }
-    while (*in)
+    while (in < end)
     {
         if (*in == '-' && islower(*(in + 1)))
         {
             ++in;
-            ajName << (char)(*in - 'a' + 'A');
+            ajName += (char)(*in - 'a' + 'A');
         }
         else if (*in == '-' && *(in + 1) == '-' &&
                  (islower(*(in + 2)) || '-' == *(in + 2)))
         {
             ++in;
-            ajName << '_';
+            ajName += '_';
         }
         else if (*in == '-')
         {
-            ajName << '_';
+            ajName += '_';
         }
         else
         {
-            ajName << *in;
+            ajName += *in;
         }
         ++in;
     }
-    return ajName.str();
 }
 
-std::string GetResourceTypeName(std::string ifaceName)
+std::string ToAJName(const std::string &ocName)
+{
+    std::string ajName;
+    ajName.reserve(ocName.size());
+    AppendAJName(ajName, ocName.c_str(), ocName.c_str() + ocName.size());
+    return ajName;
+}
+
+std::string GetResourceTypeName(const std::string &ifaceName)
 {
     return ToOCName(ifaceName);
 }
 
-std::string GetResourceTypeName(std::string ifaceName, std::string suffix)
+std::string GetResourceTypeName(const char *ifaceName, const char *suffix)
 {
-    return ToOCName(ifaceName + "." + suffix);
+    size_t ifaceLength = strlen(ifaceName);
+    size_t suffixLength = strlen(suffix);
+    std::string rt = CreateOCName(ifaceLength + 1 + suffixLength);
+    AppendOCName(rt, ifaceName);
+    rt += '.';
+    AppendOCName(rt, suffix);
+    return rt;
 }
 
-std::string GetResourceTypeName(const ajn::InterfaceDescription *iface, std::string suffix)
+std::string GetResourceTypeName(const ajn::InterfaceDescription *iface, const char *suffix)
 {
     return GetResourceTypeName(iface->GetName(), suffix);
 }
 
-std::string GetPropName(const ajn::InterfaceDescription::Member *member, std::string argName)
+std::string GetPropName(const ajn::InterfaceDescription::Member *member, const std::string &argName)
 {
-    return GetResourceTypeName(member->iface, member->name) + argName;
+    return GetResourceTypeName(member->iface, member->name.c_str()) + argName;
 }
 
-std::string GetPropName(const ajn::InterfaceDescription *iface, std::string memberName)
+std::string GetPropName(const ajn::InterfaceDescription *iface, const char *memberName)
 {
     return GetResourceTypeName(iface, memberName);
 }
 
-std::string GetInterface(std::string rt)
+std::string GetInterface(const std::string &rt)
 {
     std::string aj = ToAJName(rt);
-    return aj.substr(0, aj.rfind('.'));
+    size_t dot = aj.rfind('.');
+    if (dot != std::string::npos)
+    {
+        aj.resize(dot);
+    }
+    return aj;
 }
 
-std::string GetMember(std::string rt)
+std::string GetMember(const std::string &rt)
 {
     std::string aj = ToAJName(rt);
     return aj.substr(aj.rfind('.') + 1);
@@ -127,32 +154,112 @@ std::string GetMember(std::string rt)
 
 std::string NextArgName(const char *&argNames, size_t i)
 {
-    std::stringstream name;
     const char *argName = argNames;
-    if (*argNames)
+    while (*argNames && *argNames != ',')
     {
-        while (*argNames && *argNames != ',')
-        {
-            ++argNames;
-        }
-        if (argNames > argName)
-        {
-            name << std::string(argName, argNames - argName);
-        }
-        else
-        {
-            name << "arg" << i;
-        }
-        if (*argNames == ',')
-        {
-            ++argNames;
-        }
+        ++argNames;
+    }
+    std::string name;
+    if (argNames > argName)
+    {
+        name.assign(argName, argNames - argName);
     }
     else
     {
-        name << "arg" << i;
+        char arg[sizeof("arg") + 20];
+        snprintf(arg, sizeof(arg), "arg%zu", i);
+        name = arg;
+    }
+    if (*argNames == ',')
+    {
+        ++argNames;
+    }
+    return name;
+}
+
+size_t Names::Hash::operator()(const char *s) const
+{
+    /* FNV-1a */
+    size_t h = 2166136261u;
+    for (; *s; ++s)
+    {
+        h = (h ^ (unsigned char) *s) * 16777619u;
     }
-    return name.str();
+    return h;
+}
+
+bool Names::Equal::operator()(const char *a, const char *b) const
+{
+    return !strcmp(a, b);
+}
+
+const Names::ResourceType *Names::AddResourceType(const ajn::InterfaceDescription *iface,
+        const char *memberName)
+{
+    const ResourceType *rt = GetResourceType(iface->GetName(), memberName ? memberName : "");
+    if (rt)
+    {
+        return rt;
+    }
+    ResourceType entry;
+    entry.m_iface = iface;
+    if (memberName)
+    {
+        entry.m_memberName = memberName;
+        entry.m_rt = GetResourceTypeName(iface, memberName);
+    }
+    else
+    {
+        entry.m_rt = GetResourceTypeName(iface->GetName());
+    }
+    m_resourceTypes.push_back(entry);
+    rt = &m_resourceTypes.back();
+    m_byRt[rt->m_rt.c_str()] = rt;
+    m_byMember[iface->GetName()][rt->m_memberName.c_str()] = rt;
+    return rt;
+}
+
+const Names::Property *Names::AddProperty(const ajn::InterfaceDescription *iface,
+        const ajn::InterfaceDescription::Property *property)
+{
+    Property entry;
+    entry.m_iface = iface;
+    entry.m_property = property;
+    entry.m_propName = GetPropName(iface, property->name.c_str());
+    Properties::iterator it = m_byPropName.find(entry.m_propName.c_str());
+    if (it != m_byPropName.end())
+    {
+        return it->second;
+    }
+    m_properties.push_back(entry);
+    const Property *prop = &m_properties.back();
+    m_byPropName[prop->m_propName.c_str()] = prop;
+    return prop;
+}
+
+const Names::ResourceType *Names::GetResourceType(const char *rt) const
+{
+    ResourceTypes::const_iterator it = m_byRt.find(rt);
+    return (it == m_byRt.end()) ? NULL : it->second;
+}
+
+const Names::ResourceType *Names::GetResourceType(const char *ifaceName,
+        const char *memberName) const
+{
+    std::unordered_map<const char *, ResourceTypes, Hash, Equal>::const_iterator it =
+            m_byMember.find(ifaceName);
+    if (it == m_byMember.end())
+    {
+        return NULL;
+    }
+    ResourceTypes::const_iterator jt = it->second.find(memberName);
+    return (jt == it->second.end()) ? NULL : jt->second;
+}
+
+const Names::Property *Names::GetProperty(const char *propName) const
+{
+    Properties::const_iterator it = m_byPropName.find(propName);
+    return (it == m_byPropName.end()) ? NULL : it->second;
 }
 
 bool TranslateInterface(const char *ifaceName)
@@ -22,22 +22,74 @@
 #define _NAME_H
 
 #include <alljoyn/InterfaceDescription.h>
+#include <deque>
 #include <string>
+#include <unordered_map>
 
-std::string ToOCName(std::string ajName);
-std::string ToAJName(std::string ocName);
+std::string ToOCName(const std::string &ajName);
+std::string ToAJName(const std::string &ocName);
 
-std::string GetResourceTypeName(std::string ifaceName);
-std::string GetResourceTypeName(std::string ifaceName, std::string suffix);
-std::string GetResourceTypeName(const ajn::InterfaceDescription *iface, std::string suffix);
-std::string GetPropName(const ajn::InterfaceDescription::Member *member, std::string argName);
-std::string GetPropName(const ajn::InterfaceDescription *iface, std::string memberName);
+std::string GetResourceTypeName(const std::string &ifaceName);
+std::string GetResourceTypeName(const char *ifaceName, const char *suffix);
+std::string GetResourceTypeName(const ajn::InterfaceDescription *iface, const char *suffix);
+std::string GetPropName(const ajn::InterfaceDescription::Member *member,
+        const std::string &argName);
+std::string GetPropName(const ajn::InterfaceDescription *iface, const char *memberName);
 
-std::string GetInterface(std::string rt);
-std::string GetMember(std::string rt);
+std::string GetInterface(const std::string &rt);
+std::string GetMember(const std::string &rt);
 
 std::string NextArgName(const char *&argNames, size_t i);
 
+/*
+ * The OC names of the members and properties of an object, added once when its resources are
+ * created.  The lookups take the names as received and return entries of the table without
+ * allocating.
+ */
+class Names
+{
+    public:
+        struct ResourceType
+        {
+            const ajn::InterfaceDescription *m_iface;
+            std::string m_memberName; /* Or value of EmitsChanged, empty for the interface itself */
+            std::string m_rt;
+        };
+        struct Property
+        {
+            const ajn::InterfaceDescription *m_iface;
+            const ajn::InterfaceDescription::Property *m_property;
+            std::string m_propName;
+        };
+
+        /* A NULL memberName adds the resource type of an interface without members. */
+        const ResourceType *AddResourceType(const ajn::InterfaceDescription *iface,
+                const char *memberName);
+        const Property *AddProperty(const ajn::InterfaceDescription *iface,
+                const ajn::InterfaceDescription::Property *property);
+        const ResourceType *GetResourceType(const char *rt) const;
+        const ResourceType *GetResourceType(const char *ifaceName, const char *memberName) const;
+        const Property *GetProperty(const char *propName) const;
+
+    private:
+        struct Hash
+        {
+            size_t operator()(const char *s) const;
+        };
+        struct Equal
+        {
+            bool operator()(const char *a, const char *b) const;
+        };
+        typedef std::unordered_map<const char *, const ResourceType *, Hash, Equal> ResourceTypes;
+        typedef std::unordered_map<const char *, const Property *, Hash, Equal> Properties;
+        /* The keys of the indexes point into these, which do not move when added to */
+        std::deque<ResourceType> m_resourceTypes;
+        std::deque<Property> m_properties;
+        ResourceTypes m_byRt;
+        std::unordered_map<const char *, ResourceTypes, Hash, Equal> m_byMember; /* By iface */
+        Properties m_byPropName;
+};
+
 bool TranslateInterface(const char *ifaceName);
 bool IsValidErrorName(const char *np, const char **endp);
 
@@ -28,10 +28,35 @@
 #include <assert.h>
 #include <math.h>
 
-std::map<std::string, std::vector<Types::Field>> Types::m_structs;
+const Types::Fields *Types::GetFields(const std::string &name) const
+{
+    Structs::const_iterator it = m_structs.find(name);
+    return (it == m_structs.end()) ? NULL : &it->second;
+}
+
+/*
+ * Only rectangular arrays are allowed.  An unset dimension is 0, so an empty dimension, which
+ * an OC array cannot hold anyway, is rejected rather than letting a later row set it.
+ */
+static bool SetDim(OCRepPayloadValueArray *arr, uint8_t di, size_t dim)
+{
+    if (!dim)
+    {
+        return false;
+    }
+    else if (arr->dimensions[di])
+    {
+        return (arr->dimensions[di] == dim);
+    }
+    else
+    {
+        arr->dimensions[di] = dim;
+        return true;
+    }
+}
 
 static bool calcDim(OCRepPayloadValueArray *arr,
-                    uint8_t di, const ajn::MsgArg *arg, const char *signature)
+                    uint8_t di, const ajn::MsgArg *arg, const char *signature, const Types *types)
 {
     if (di >= MAX_REP_ARRAY_DEPTH)
     {
@@ -66,15 +91,7 @@ static bool calcDim(OCRepPayloadValueArray *arr,
             {
                 case ajn::ALLJOYN_BOOLEAN:
                     arr->type = OCREP_PROP_BOOL;
-                    if (arr->dimensions[di])
-                    {
-                        /* Only rectangular arrays are allowed */
-                        success = (arr->dimensions[di] == arg->v_scalarArray.numElements);
-                    }
-                    else
-                    {
-                        arr->dimensions[di] = arg->v_scalarArray.numElements;
-                    }
+                    success = SetDim(arr, di, arg->v_scalarArray.numElements);
                     break;
                 case ajn::ALLJOYN_BYTE:
                     arr->type = OCREP_PROP_BYTE_STRING;
@@ -86,36 +103,20 @@ static bool calcDim(OCRepPayloadValueArray *arr,
                 case ajn::ALLJOYN_INT64:
                 case ajn::ALLJOYN_UINT64:
                     arr->type = OCREP_PROP_INT;
-                    if (arr->dimensions[di])
-                    {
-                        /* Only rectangular arrays are allowed */
-                        success = (arr->dimensions[di] == arg->v_scalarArray.numElements);
-                    }
-                    else
-                    {
-                        arr->dimensions[di] = arg->v_scalarArray.numElements;
-                    }
+                    success = SetDim(arr, di, arg->v_scalarArray.numElements);
                     break;
                 case ajn::ALLJOYN_DOUBLE:
                     arr->type = OCREP_PROP_DOUBLE;
-                    if (arr->dimensions[di])
-                    {
-                        /* Only rectangular arrays are allowed */
-                        success = (arr->dimensions[di] == arg->v_scalarArray.numElements);
-                    }
-                    else
-                    {
-                        arr->dimensions[di] = arg->v_scalarArray.numElements;
-                    }
+                    success = SetDim(arr, di, arg->v_scalarArray.numElements);
                     break;
                 case ajn::ALLJOYN_DICT_ENTRY_OPEN:
                     arr->type = OCREP_PROP_OBJECT;
                     break;
                 default:
-                    arr->dimensions[di] = arg->v_array.GetNumElements();
+                    success = SetDim(arr, di, arg->v_array.GetNumElements());
                     for (size_t i = 0; success && i < arr->dimensions[di]; ++i)
                     {
-                        success = calcDim(arr, di + 1, &arg->v_array.GetElements()[i], &signature[1]);
+                        success = calcDim(arr, di + 1, &arg->v_array.GetElements()[i], &signature[1], types);
                     }
                     break;
             }
@@ -146,8 +147,68 @@ static bool calcDim(OCRepPayloadValueArray *arr,
     return success;
 }
 
+/* Widens a row of integers one type at a time, in loops simple enough to vectorize. */
+static void ToIntArray(int64_t *iArray, const ajn::MsgArg *arg, char typeId)
+{
+    size_t numElems = arg->v_scalarArray.numElements;
+    switch (typeId)
+    {
+        case ajn::ALLJOYN_INT16:
+            {
+                const int16_t *v_int16 = arg->v_scalarArray.v_int16;
+                for (size_t i = 0; i < numElems; ++i)
+                {
+                    iArray[i] = v_int16[i];
+                }
+                break;
+            }
+        case ajn::ALLJOYN_UINT16:
+            {
+                const uint16_t *v_uint16 = arg->v_scalarArray.v_uint16;
+                for (size_t i = 0; i < numElems; ++i)
+                {
+                    iArray[i] = v_uint16[i];
+                }
+                break;
+            }
+        case ajn::ALLJOYN_INT32:
+            {
+                const int32_t *v_int32 = arg->v_scalarArray.v_int32;
+                for (size_t i = 0; i < numElems; ++i)
+                {
+                    iArray[i] = v_int32[i];
+                }
+                break;
+            }
+        case ajn::ALLJOYN_UINT32:
+            {
+                const uint32_t *v_uint32 = arg->v_scalarArray.v_uint32;
+                for (size_t i = 0; i < numElems; ++i)
+                {
+                    iArray[i] = v_uint32[i];
+                }
+                break;
+            }
+        case ajn::ALLJOYN_INT64:
+            memcpy(iArray, arg->v_scalarArray.v_int64, numElems * sizeof(int64_t));
+            break;
+        case ajn::ALLJOYN_UINT64:
+            {
+                const uint64_t *v_uint64 = arg->v_scalarArray.v_uint64;
+                for (size_t i = 0; i < numElems; ++i)
+                {
+                    iArray[i] = v_uint64[i];
+                }
+                break;
+            }
+        default:
+            assert(0);
+            break;
+    }
+}
+
 static bool CloneArray(OCRepPayloadValueArray *arr, size_t *ai, uint8_t di,
-                       const ajn::MsgArg *arg, const char *signature)
+                       const ajn::MsgArg *arg, const char *signature, const Types *types)
 {
     bool success = true;
     switch (signature[0])
@@ -198,44 +259,14 @@ static bool CloneArray(OCRepPayloadValueArray *arr, size_t *ai, uint8_t di,
                         break;
                     }
                 case ajn::ALLJOYN_INT16:
-                    assert(arr->dimensions[di] == arg->v_scalarArray.numElements);
-                    for (size_t i = 0; i < arr->dimensions[di]; ++i)
-                    {
-                        arr->iArray[(*ai)++] = arg->v_scalarArray.v_int16[i];
-                    }
-                    break;
                 case ajn::ALLJOYN_UINT16:
-                    assert(arr->dimensions[di] == arg->v_scalarArray.numElements);
-                    for (size_t i = 0; i < arr->dimensions[di]; ++i)
-                    {
-                        arr->iArray[(*ai)++] = arg->v_scalarArray.v_uint16[i];
-                    }
-                    break;
                 case ajn::ALLJOYN_INT32:
-                    assert(arr->dimensions[di] == arg->v_scalarArray.numElements);
-                    for (size_t i = 0; i < arr->dimensions[di]; ++i)
-                    {
-                        arr->iArray[(*ai)++] = arg->v_scalarArray.v_int32[i];
-                    }
-                    break;
                 case ajn::ALLJOYN_UINT32:
-                    assert(arr->dimensions[di] == arg->v_scalarArray.numElements);
-                    for (size_t i = 0; i < arr->dimensions[di]; ++i)
-                    {
-                        arr->iArray[(*ai)++] = arg->v_scalarArray.v_uint32[i];
-                    }
-                    break;
                 case ajn::ALLJOYN_INT64:
-                    assert(arr->dimensions[di] == arg->v_scalarArray.numElements);
-                    memcpy(&arr->iArray[(*ai)], arg->v_scalarArray.v_int64, arr->dimensions[di] * sizeof(int64_t));
-                    (*ai) += arr->dimensions[di];
-                    break;
                 case ajn::ALLJOYN_UINT64:
                     assert(arr->dimensions[di] == arg->v_scalarArray.numElements);
-                    for (size_t i = 0; i < arr->dimensions[di]; ++i)
-                    {
-                        arr->iArray[(*ai)++] = arg->v_scalarArray.v_uint64[i];
-                    }
+                    ToIntArray(&arr->iArray[(*ai)], arg, signature[1]);
+                    (*ai) += arr->dimensions[di];
                     break;
                 case ajn::ALLJOYN_DOUBLE:
                     assert(arr->dimensions[di] == arg->v_scalarArray.numElements);
@@ -252,7 +283,7 @@ static bool CloneArray(OCRepPayloadValueArray *arr, size_t *ai, uint8_t di,
                         }
                         for (size_t i = 0; success && i < arg->v_array.GetNumElements(); ++i)
                         {
-                            success = ToOCPayload(value, NULL, &arg->v_array.GetElements()[i], &signature[1]);
+                            success = ToOCPayload(value, NULL, &arg->v_array.GetElements()[i], &signature[1], types);
                         }
                         if (success)
                         {
@@ -266,7 +297,7 @@ static bool CloneArray(OCRepPayloadValueArray *arr, size_t *ai, uint8_t di,
                 default:
                     for (size_t i = 0; success && i < arr->dimensions[di]; ++i)
                     {
-                        success = CloneArray(arr, ai, di + 1, &arg->v_array.GetElements()[i], &signature[1]);
+                        success = CloneArray(arr, ai, di + 1, &arg->v_array.GetElements()[i], &signature[1], types);
                     }
             }
             break;
@@ -287,7 +318,7 @@ static bool CloneArray(OCRepPayloadValueArray *arr, size_t *ai, uint8_t di,
                     fieldSignature = signature;
                     char name[16];
                     snprintf(name, 16, "%zu", i);
-                    success = ToOCPayload(value, name, &arg->v_struct.members[i], sig.c_str());
+                    success = ToOCPayload(value, name, &arg->v_struct.members[i], sig.c_str(), types);
                 }
                 if (success)
                 {
@@ -326,13 +357,13 @@ static bool CloneArray(OCRepPayloadValueArray *arr, size_t *ai, uint8_t di,
                     success = false;
                     break;
                 }
+                const Types::Fields *fields = types ? types->GetFields(signature) : NULL;
+                success = fields && (fields->size() == arg->v_struct.numMembers);
                 for (size_t i = 0; success && i < arg->v_struct.numMembers; ++i)
                 {
-                    assert(Types::m_structs.find(signature) != Types::m_structs.end());
-                    assert(i < Types::m_structs[signature].size());
-                    Types::Field &field = Types::m_structs[signature][i];
+                    const Types::Field &field = (*fields)[i];
                     success = ToOCPayload(value, field.m_name.c_str(), &arg->v_struct.members[i],
-                                          field.m_signature.c_str());
+                                          field.m_signature.c_str(), types);
                 }
                 if (success)
                 {
@@ -389,11 +420,11 @@ static void DestroyArray(OCRepPayloadValueArray *arr)
 }
 
 static bool SetPropArray(OCRepPayload *payload, const char *name, const ajn::MsgArg *arg,
-                         const char *signature)
+                         const char *signature, const Types *types)
 {
     OCRepPayloadValueArray arr;
     memset(&arr, 0, sizeof(arr));
-    if (!calcDim(&arr, 0, arg, signature))
+    if (!calcDim(&arr, 0, arg, signature, types))
     {
         return false;
     }
@@ -416,7 +447,7 @@ static bool SetPropArray(OCRepPayload *payload, const char *name, const ajn::Msg
         return false;
     }
     size_t i = 0;
-    bool success = CloneArray(&arr, &i, 0, arg, signature);
+    bool success = CloneArray(&arr, &i, 0, arg, signature, types);
     if (success)
     {
         switch (arr.type)
@@ -444,8 +475,59 @@ static bool SetPropArray(OCRepPayload *payload, const char *name, const ajn::Msg
     return success;
 }
 
+/* Returns NULL when key is not of a basic type, buf must be at least 64 bytes. */
+static const char *GetKeyName(const ajn::MsgArg *key, char typeId, char *buf)
+{
+    const char *keyName = buf;
+    switch (typeId)
+    {
+        case ajn::ALLJOYN_BOOLEAN:
+            keyName = key->v_bool ? "true" : "false";
+            break;
+        case ajn::ALLJOYN_BYTE:
+            sprintf(buf, "%u", key->v_byte);
+            break;
+        case ajn::ALLJOYN_INT16:
+            sprintf(buf, "%d", key->v_int16);
+            break;
+        case ajn::ALLJOYN_UINT16:
+            sprintf(buf, "%u", key->v_uint16);
+            break;
+        case ajn::ALLJOYN_INT32:
+            sprintf(buf, "%d", key->v_int32);
+            break;
+        case ajn::ALLJOYN_UINT32:
+            sprintf(buf, "%u", key->v_uint32);
+            break;
+        case ajn::ALLJOYN_INT64:
+            sprintf(buf, "%" PRIi64, key->v_int64);
+            break;
+        case ajn::ALLJOYN_UINT64:
+            sprintf(buf, "%" PRIu64, key->v_uint64);
+            break;
+        case ajn::ALLJOYN_DOUBLE:
+            sprintf(buf, "%f", key->v_double);
+            break;
+        case ajn::ALLJOYN_STRING:
+        case ajn::ALLJOYN_OBJECT_PATH:
+            keyName = key->v_string.str;
+            break;
+        case ajn::ALLJOYN_SIGNATURE:
+            keyName = key->v_signature.sig;
+            break;
+        case ajn::ALLJOYN_HANDLE:
+            keyName = NULL; /* Explicitly not supported */
+            break;
+        default:
+            keyName = NULL; /* Only basic types are allowed as keys */
+            break;
+    }
+    return keyName;
+}
+
 bool ToOCPayload(OCRepPayload *payload,
-                 const char *name, const ajn::MsgArg *arg, const char *signature)
+                 const char *name, const ajn::MsgArg *arg, const char *signature,
+                 const Types *types)
 {
     bool success = false;
     switch (signature[0])
@@ -517,7 +599,7 @@ bool ToOCPayload(OCRepPayload *payload,
                         success = true;
                         for (size_t i = 0; success && i < arg->v_array.GetNumElements(); ++i)
                         {
-                            success = ToOCPayload(value, NULL, &arg->v_array.GetElements()[i], &signature[1]);
+                            success = ToOCPayload(value, NULL, &arg->v_array.GetElements()[i], &signature[1], types);
                         }
                         if (success)
                         {
@@ -530,7 +612,7 @@ bool ToOCPayload(OCRepPayload *payload,
                         break;
                     }
                 default:
-                    success = SetPropArray(payload, name, arg, signature);
+                    success = SetPropArray(payload, name, arg, signature, types);
                     break;
             }
             break;
@@ -551,7 +633,7 @@ bool ToOCPayload(OCRepPayload *payload,
                     fieldSignature = signature;
                     char name[16];
                     snprintf(name, 16, "%zu", i);
-                    success = ToOCPayload(value, name, &arg->v_struct.members[i], sig.c_str());
+                    success = ToOCPayload(value, name, &arg->v_struct.members[i], sig.c_str(), types);
                 }
                 if (success)
                 {
@@ -564,7 +646,8 @@ bool ToOCPayload(OCRepPayload *payload,
                 break;
             }
         case ajn::ALLJOYN_VARIANT:
-            success = ToOCPayload(payload, name, arg->v_variant.val, arg->v_variant.val->Signature().c_str());
+            success = ToOCPayload(payload, name, arg->v_variant.val,
+                                  arg->v_variant.val->Signature().c_str(), types);
             break;
         case ajn::ALLJOYN_DICT_ENTRY_OPEN:
             {
@@ -575,53 +658,14 @@ bool ToOCPayload(OCRepPayload *payload,
                 const char *valSignature = entrySig;
                 ParseCompleteType(entrySig);
                 std::string valSig(valSignature, entrySig - valSignature);
-                ajn::MsgArg *key = arg->v_dictEntry.key;
                 char keyNameBuf[64];
-                const char *keyName = keyNameBuf;
-                switch (keySig[0])
+                const char *keyName = GetKeyName(arg->v_dictEntry.key, keySig[0], keyNameBuf);
+                if (!keyName)
                 {
-                    case ajn::ALLJOYN_BOOLEAN:
-                        keyName = key->v_bool ? "true" : "false";
-                        break;
-                    case ajn::ALLJOYN_BYTE:
-                        sprintf(keyNameBuf, "%u", key->v_byte);
-                        break;
-                    case ajn::ALLJOYN_INT16:
-                        sprintf(keyNameBuf, "%d", key->v_int16);
-                        break;
-                    case ajn::ALLJOYN_UINT16:
-                        sprintf(keyNameBuf, "%u", key->v_uint16);
-                        break;
-                    case ajn::ALLJOYN_INT32:
-                        sprintf(keyNameBuf, "%d", key->v_int32);
-                        break;
-                    case ajn::ALLJOYN_UINT32:
-                        sprintf(keyNameBuf, "%u", key->v_uint32);
-                        break;
-                    case ajn::ALLJOYN_INT64:
-                        sprintf(keyNameBuf, "%" PRIi64, key->v_int64);
-                        break;
-                    case ajn::ALLJOYN_UINT64:
-                        sprintf(keyNameBuf, "%" PRIu64, key->v_uint64);
-                        break;
-                    case ajn::ALLJOYN_DOUBLE:
-                        sprintf(keyNameBuf, "%f", key->v_double);
-                        break;
-                    case ajn::ALLJOYN_STRING:
-                    case ajn::ALLJOYN_OBJECT_PATH:
-                        keyName = key->v_string.str;
-                        break;
-                    case ajn::ALLJOYN_SIGNATURE:
-                        keyName = key->v_signature.sig;
-                        break;
-                    case ajn::ALLJOYN_HANDLE:
-                        success = false; /* Explicitly not supported */
-                        break;
-                    default:
-                        success = false; /* Only basic types are allowed as keys */
-                        break;
+                    success = false;
+                    break;
                 }
-                success = ToOCPayload(payload, keyName, arg->v_dictEntry.val, valSig.c_str());
+                success = ToOCPayload(payload, keyName, arg->v_dictEntry.val, valSig.c_str(), types);
                 break;
             }
 
@@ -644,14 +688,13 @@ bool ToOCPayload(OCRepPayload *payload,
                 {
                     break;
                 }
-                success = true;
+                const Types::Fields *fields = types ? types->GetFields(signature) : NULL;
+                success = fields && (fields->size() == arg->v_struct.numMembers);
                 for (size_t i = 0; success && i < arg->v_struct.numMembers; ++i)
                 {
-                    assert(Types::m_structs.find(signature) != Types::m_structs.end());
-                    assert(i < Types::m_structs[signature].size());
-                    Types::Field &field = Types::m_structs[signature][i];
+                    const Types::Field &field = (*fields)[i];
                     success = ToOCPayload(value, field.m_name.c_str(), &arg->v_struct.members[i],
-                                          field.m_signature.c_str());
+                                          field.m_signature.c_str(), types);
                 }
                 if (success)
                 {
@@ -668,8 +711,33 @@ bool ToOCPayload(OCRepPayload *payload,
     return success;
 }
 
+/*
+ * The checks below look at every value instead of stopping at the first one out of range so
+ * that the compiler can vectorize them.  The values are converted after all of them pass.
+ */
+static bool InRange(const int64_t *values, size_t numValues, int64_t min, int64_t max)
+{
+    size_t outOfRange = 0;
+    for (size_t i = 0; i < numValues; ++i)
+    {
+        outOfRange += (values[i] < min) | (values[i] > max);
+    }
+    return !outOfRange;
+}
+
+static bool IsIntegral(const double *values, size_t numValues, double min, double max)
+{
+    size_t notIntegral = 0;
+    for (size_t i = 0; i < numValues; ++i)
+    {
+        /* NaN is caught by the first comparison */
+        notIntegral += (floor(values[i]) != values[i]) | (values[i] < min) | (values[i] > max);
+    }
+    return !notIntegral;
+}
+
 static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
-                       OCRepPayloadValueArray *arr, size_t *ai, uint8_t di)
+                       OCRepPayloadValueArray *arr, size_t *ai, uint8_t di, const Types *types)
 {
     bool success = true;
     switch (signature[0])
@@ -706,24 +774,26 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
             {
                 case ajn::ALLJOYN_BOOLEAN:
                     {
-                        bool *v_bool = new bool[arr->dimensions[di]];
-                        for (size_t i = 0; success && i < arr->dimensions[di]; ++i, ++(*ai))
+                        size_t numElems = arr->dimensions[di];
+                        bool *v_bool = new bool[numElems];
+                        switch (arr->type)
                         {
-                            switch (arr->type)
-                            {
-                                case OCREP_PROP_INT:
-                                case OCREP_PROP_DOUBLE:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_BOOL:
-                                    v_bool[i] = arr->bArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_STRING:
-                                    if (!strcmp(arr->strArray[(*ai)], "true"))
+                            case OCREP_PROP_INT:
+                            case OCREP_PROP_DOUBLE:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_BOOL:
+                                memcpy(v_bool, &arr->bArray[(*ai)], numElems * sizeof(bool));
+                                break;
+                            case OCREP_PROP_STRING:
+                                for (size_t i = 0; success && i < numElems; ++i)
+                                {
+                                    const char *str = arr->strArray[(*ai) + i];
+                                    if (!strcmp(str, "true"))
                                     {
                                         v_bool[i] = true;
                                     }
-                                    else if (!strcmp(arr->strArray[(*ai)], "false"))
+                                    else if (!strcmp(str, "false"))
                                     {
                                         v_bool[i] = false;
                                     }
@@ -731,22 +801,24 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                                     {
                                         success = false;
                                     }
-                                    break;
-                                case OCREP_PROP_BYTE_STRING:
-                                case OCREP_PROP_OBJECT:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_NULL:
-                                    break; /* Explicitly not supported */
-                                case OCREP_PROP_ARRAY:
-                                    assert(0); /* Not used as an array value type */
-                                    break;
-                            }
+                                }
+                                break;
+                            case OCREP_PROP_BYTE_STRING:
+                            case OCREP_PROP_OBJECT:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_NULL:
+                                success = false; /* Explicitly not supported */
+                                break;
+                            case OCREP_PROP_ARRAY:
+                                assert(0); /* Not used as an array value type */
+                                break;
                         }
                         if (success)
                         {
+                            (*ai) += numElems;
                             arg->typeId = ajn::ALLJOYN_BOOLEAN_ARRAY;
-                            arg->v_scalarArray.numElements = arr->dimensions[di];
+                            arg->v_scalarArray.numElements = numElems;
                             arg->v_scalarArray.v_bool = v_bool;
                             arg->SetOwnershipFlags(ajn::MsgArg::OwnsData, false);
                         }
@@ -758,53 +830,63 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                     }
                 case ajn::ALLJOYN_BYTE:
                     {
-                        uint8_t *v_byte = new uint8_t[arr->dimensions[di]];
-                        for (size_t i = 0; success && i < arr->dimensions[di]; ++i, ++(*ai))
+                        size_t numElems = arr->dimensions[di];
+                        uint8_t *v_byte = new uint8_t[numElems];
+                        switch (arr->type)
                         {
-                            switch (arr->type)
-                            {
-                                case OCREP_PROP_INT:
-                                    success = (0 <= arr->iArray[(*ai)] && arr->iArray[(*ai)] <= UINT8_MAX);
-                                    if (success)
-                                    {
-                                        v_byte[i] = arr->iArray[(*ai)];
-                                    }
-                                    break;
-                                case OCREP_PROP_DOUBLE:
-                                    success = (floor(arr->dArray[(*ai)]) == arr->dArray[(*ai)]);
-                                    if (success)
+                            case OCREP_PROP_INT:
+                                success = InRange(&arr->iArray[(*ai)], numElems, 0, UINT8_MAX);
+                                if (success)
+                                {
+                                    const int64_t *iArray = &arr->iArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = (0 <= arr->dArray[(*ai)] && arr->dArray[(*ai)] <= UINT8_MAX);
+                                        v_byte[i] = iArray[i];
                                     }
-                                    if (success)
+                                }
+                                break;
+                            case OCREP_PROP_DOUBLE:
+                                success = IsIntegral(&arr->dArray[(*ai)], numElems, 0, UINT8_MAX);
+                                if (success)
+                                {
+                                    const double *dArray = &arr->dArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        v_byte[i] = arr->dArray[(*ai)];
+                                        v_byte[i] = dArray[i];
                                     }
-                                    break;
-                                case OCREP_PROP_BOOL:
-                                    v_byte[i] = arr->bArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_STRING:
-                                    if (sscanf(arr->strArray[(*ai)], "%" SCNu8, &v_byte[i]) != 1)
+                                }
+                                break;
+                            case OCREP_PROP_BOOL:
+                                {
+                                    const bool *bArray = &arr->bArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = false;
+                                        v_byte[i] = bArray[i];
                                     }
                                     break;
-                                case OCREP_PROP_BYTE_STRING:
-                                case OCREP_PROP_OBJECT:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_NULL:
-                                    break; /* Explicitly not supported */
-                                case OCREP_PROP_ARRAY:
-                                    assert(0); /* Not used as an array value type */
-                                    break;
-                            }
+                                }
+                            case OCREP_PROP_STRING:
+                                for (size_t i = 0; success && i < numElems; ++i)
+                                {
+                                    success = (sscanf(arr->strArray[(*ai) + i], "%" SCNu8, &v_byte[i]) == 1);
+                                }
+                                break;
+                            case OCREP_PROP_BYTE_STRING:
+                            case OCREP_PROP_OBJECT:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_NULL:
+                                success = false; /* Explicitly not supported */
+                                break;
+                            case OCREP_PROP_ARRAY:
+                                assert(0); /* Not used as an array value type */
+                                break;
                         }
                         if (success)
                         {
+                            (*ai) += numElems;
                             arg->typeId = ajn::ALLJOYN_BYTE_ARRAY;
-                            arg->v_scalarArray.numElements = arr->dimensions[di];
+                            arg->v_scalarArray.numElements = numElems;
                             arg->v_scalarArray.v_byte = v_byte;
                             arg->SetOwnershipFlags(ajn::MsgArg::OwnsData, false);
                         }
@@ -816,53 +898,63 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                     }
                 case ajn::ALLJOYN_INT16:
                     {
-                        int16_t *v_int16 = new int16_t[arr->dimensions[di]];
-                        for (size_t i = 0; success && i < arr->dimensions[di]; ++i, ++(*ai))
+                        size_t numElems = arr->dimensions[di];
+                        int16_t *v_int16 = new int16_t[numElems];
+                        switch (arr->type)
                         {
-                            switch (arr->type)
-                            {
-                                case OCREP_PROP_INT:
-                                    success = (INT16_MIN <= arr->iArray[(*ai)] && arr->iArray[(*ai)] <= INT16_MAX);
-                                    if (success)
-                                    {
-                                        v_int16[i] = arr->iArray[(*ai)];
-                                    }
-                                    break;
-                                case OCREP_PROP_DOUBLE:
-                                    success = (floor(arr->dArray[(*ai)]) == arr->dArray[(*ai)]);
-                                    if (success)
+                            case OCREP_PROP_INT:
+                                success = InRange(&arr->iArray[(*ai)], numElems, INT16_MIN, INT16_MAX);
+                                if (success)
+                                {
+                                    const int64_t *iArray = &arr->iArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = (INT16_MIN <= arr->dArray[(*ai)] && arr->dArray[(*ai)] <= INT16_MAX);
+                                        v_int16[i] = iArray[i];
                                     }
-                                    if (success)
+                                }
+                                break;
+                            case OCREP_PROP_DOUBLE:
+                                success = IsIntegral(&arr->dArray[(*ai)], numElems, INT16_MIN, INT16_MAX);
+                                if (success)
+                                {
+                                    const double *dArray = &arr->dArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        v_int16[i] = arr->dArray[(*ai)];
+                                        v_int16[i] = dArray[i];
                                     }
-                                    break;
-                                case OCREP_PROP_BOOL:
-                                    v_int16[i] = arr->bArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_STRING:
-                                    if (sscanf(arr->strArray[(*ai)], "%" SCNd16, &v_int16[i]) != 1)
+                                }
+                                break;
+                            case OCREP_PROP_BOOL:
+                                {
+                                    const bool *bArray = &arr->bArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = false;
+                                        v_int16[i] = bArray[i];
                                     }
                                     break;
-                                case OCREP_PROP_BYTE_STRING:
-                                case OCREP_PROP_OBJECT:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_NULL:
-                                    break; /* Explicitly not supported */
-                                case OCREP_PROP_ARRAY:
-                                    assert(0); /* Not used as an array value type */
-                                    break;
-                            }
+                                }
+                            case OCREP_PROP_STRING:
+                                for (size_t i = 0; success && i < numElems; ++i)
+                                {
+                                    success = (sscanf(arr->strArray[(*ai) + i], "%" SCNd16, &v_int16[i]) == 1);
+                                }
+                                break;
+                            case OCREP_PROP_BYTE_STRING:
+                            case OCREP_PROP_OBJECT:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_NULL:
+                                success = false; /* Explicitly not supported */
+                                break;
+                            case OCREP_PROP_ARRAY:
+                                assert(0); /* Not used as an array value type */
+                                break;
                         }
                         if (success)
                         {
+                            (*ai) += numElems;
                             arg->typeId = ajn::ALLJOYN_INT16_ARRAY;
-                            arg->v_scalarArray.numElements = arr->dimensions[di];
+                            arg->v_scalarArray.numElements = numElems;
                             arg->v_scalarArray.v_int16 = v_int16;
                             arg->SetOwnershipFlags(ajn::MsgArg::OwnsData, false);
                         }
@@ -874,53 +966,63 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                     }
                 case ajn::ALLJOYN_UINT16:
                     {
-                        uint16_t *v_uint16 = new uint16_t[arr->dimensions[di]];
-                        for (size_t i = 0; success && i < arr->dimensions[di]; ++i, ++(*ai))
+                        size_t numElems = arr->dimensions[di];
+                        uint16_t *v_uint16 = new uint16_t[numElems];
+                        switch (arr->type)
                         {
-                            switch (arr->type)
-                            {
-                                case OCREP_PROP_INT:
-                                    success = (0 <= arr->iArray[(*ai)] && arr->iArray[(*ai)] <= UINT16_MAX);
-                                    if (success)
-                                    {
-                                        v_uint16[i] = arr->iArray[(*ai)];
-                                    }
-                                    break;
-                                case OCREP_PROP_DOUBLE:
-                                    success = (floor(arr->dArray[(*ai)]) == arr->dArray[(*ai)]);
-                                    if (success)
+                            case OCREP_PROP_INT:
+                                success = InRange(&arr->iArray[(*ai)], numElems, 0, UINT16_MAX);
+                                if (success)
+                                {
+                                    const int64_t *iArray = &arr->iArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = (0 <= arr->dArray[(*ai)] && arr->dArray[(*ai)] <= UINT16_MAX);
+                                        v_uint16[i] = iArray[i];
                                     }
-                                    if (success)
+                                }
+                                break;
+                            case OCREP_PROP_DOUBLE:
+                                success = IsIntegral(&arr->dArray[(*ai)], numElems, 0, UINT16_MAX);
+                                if (success)
+                                {
+                                    const double *dArray = &arr->dArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        v_uint16[i] = arr->dArray[(*ai)];
+                                        v_uint16[i] = dArray[i];
                                     }
-                                    break;
-                                case OCREP_PROP_BOOL:
-                                    v_uint16[i] = arr->bArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_STRING:
-                                    if (sscanf(arr->strArray[(*ai)], "%" SCNu16, &v_uint16[i]) != 1)
+                                }
+                                break;
+                            case OCREP_PROP_BOOL:
+                                {
+                                    const bool *bArray = &arr->bArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = false;
+                                        v_uint16[i] = bArray[i];
                                     }
                                     break;
-                                case OCREP_PROP_BYTE_STRING:
-                                case OCREP_PROP_OBJECT:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_NULL:
-                                    break; /* Explicitly not supported */
-                                case OCREP_PROP_ARRAY:
-                                    assert(0); /* Not used as an array value type */
-                                    break;
-                            }
+                                }
+                            case OCREP_PROP_STRING:
+                                for (size_t i = 0; success && i < numElems; ++i)
+                                {
+                                    success = (sscanf(arr->strArray[(*ai) + i], "%" SCNu16, &v_uint16[i]) == 1);
+                                }
+                                break;
+                            case OCREP_PROP_BYTE_STRING:
+                            case OCREP_PROP_OBJECT:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_NULL:
+                                success = false; /* Explicitly not supported */
+                                break;
+                            case OCREP_PROP_ARRAY:
+                                assert(0); /* Not used as an array value type */
+                                break;
                         }
                         if (success)
                         {
+                            (*ai) += numElems;
                             arg->typeId = ajn::ALLJOYN_UINT16_ARRAY;
-                            arg->v_scalarArray.numElements = arr->dimensions[di];
+                            arg->v_scalarArray.numElements = numElems;
                             arg->v_scalarArray.v_uint16 = v_uint16;
                             arg->SetOwnershipFlags(ajn::MsgArg::OwnsData, false);
                         }
@@ -932,53 +1034,63 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                     }
                 case ajn::ALLJOYN_INT32:
                     {
-                        int32_t *v_int32 = new int32_t[arr->dimensions[di]];
-                        for (size_t i = 0; success && i < arr->dimensions[di]; ++i, ++(*ai))
+                        size_t numElems = arr->dimensions[di];
+                        int32_t *v_int32 = new int32_t[numElems];
+                        switch (arr->type)
                         {
-                            switch (arr->type)
-                            {
-                                case OCREP_PROP_INT:
-                                    success = (INT32_MIN <= arr->iArray[(*ai)] && arr->iArray[(*ai)] <= INT32_MAX);
-                                    if (success)
-                                    {
-                                        v_int32[i] = arr->iArray[(*ai)];
-                                    }
-                                    break;
-                                case OCREP_PROP_DOUBLE:
-                                    success = (floor(arr->dArray[(*ai)]) == arr->dArray[(*ai)]);
-                                    if (success)
+                            case OCREP_PROP_INT:
+                                success = InRange(&arr->iArray[(*ai)], numElems, INT32_MIN, INT32_MAX);
+                                if (success)
+                                {
+                                    const int64_t *iArray = &arr->iArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = (INT32_MIN <= arr->dArray[(*ai)] && arr->dArray[(*ai)] <= INT32_MAX);
+                                        v_int32[i] = iArray[i];
                                     }
-                                    if (success)
+                                }
+                                break;
+                            case OCREP_PROP_DOUBLE:
+                                success = IsIntegral(&arr->dArray[(*ai)], numElems, INT32_MIN, INT32_MAX);
+                                if (success)
+                                {
+                                    const double *dArray = &arr->dArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        v_int32[i] = arr->dArray[(*ai)];
+                                        v_int32[i] = dArray[i];
                                     }
-                                    break;
-                                case OCREP_PROP_BOOL:
-                                    v_int32[i] = arr->bArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_STRING:
-                                    if (sscanf(arr->strArray[(*ai)], "%" SCNd32, &v_int32[i]) != 1)
+                                }
+                                break;
+                            case OCREP_PROP_BOOL:
+                                {
+                                    const bool *bArray = &arr->bArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = false;
+                                        v_int32[i] = bArray[i];
                                     }
                                     break;
-                                case OCREP_PROP_BYTE_STRING:
-                                case OCREP_PROP_OBJECT:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_NULL:
-                                    break; /* Explicitly not supported */
-                                case OCREP_PROP_ARRAY:
-                                    assert(0); /* Not used as an array value type */
-                                    break;
-                            }
+                                }
+                            case OCREP_PROP_STRING:
+                                for (size_t i = 0; success && i < numElems; ++i)
+                                {
+                                    success = (sscanf(arr->strArray[(*ai) + i], "%" SCNd32, &v_int32[i]) == 1);
+                                }
+                                break;
+                            case OCREP_PROP_BYTE_STRING:
+                            case OCREP_PROP_OBJECT:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_NULL:
+                                success = false; /* Explicitly not supported */
+                                break;
+                            case OCREP_PROP_ARRAY:
+                                assert(0); /* Not used as an array value type */
+                                break;
                         }
                         if (success)
                         {
+                            (*ai) += numElems;
                             arg->typeId = ajn::ALLJOYN_INT32_ARRAY;
-                            arg->v_scalarArray.numElements = arr->dimensions[di];
+                            arg->v_scalarArray.numElements = numElems;
                             arg->v_scalarArray.v_int32 = v_int32;
                             arg->SetOwnershipFlags(ajn::MsgArg::OwnsData, false);
                         }
@@ -990,53 +1102,63 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                     }
                 case ajn::ALLJOYN_UINT32:
                     {
-                        uint32_t *v_uint32 = new uint32_t[arr->dimensions[di]];
-                        for (size_t i = 0; success && i < arr->dimensions[di]; ++i, ++(*ai))
+                        size_t numElems = arr->dimensions[di];
+                        uint32_t *v_uint32 = new uint32_t[numElems];
+                        switch (arr->type)
                         {
-                            switch (arr->type)
-                            {
-                                case OCREP_PROP_INT:
-                                    success = (0 <= arr->iArray[(*ai)] && arr->iArray[(*ai)] <= UINT32_MAX);
-                                    if (success)
-                                    {
-                                        v_uint32[i] = arr->iArray[(*ai)];
-                                    }
-                                    break;
-                                case OCREP_PROP_DOUBLE:
-                                    success = (floor(arr->dArray[(*ai)]) == arr->dArray[(*ai)]);
-                                    if (success)
+                            case OCREP_PROP_INT:
+                                success = InRange(&arr->iArray[(*ai)], numElems, 0, UINT32_MAX);
+                                if (success)
+                                {
+                                    const int64_t *iArray = &arr->iArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = (0 <= arr->dArray[(*ai)] && arr->dArray[(*ai)] <= UINT32_MAX);
+                                        v_uint32[i] = iArray[i];
                                     }
-                                    if (success)
+                                }
+                                break;
+                            case OCREP_PROP_DOUBLE:
+                                success = IsIntegral(&arr->dArray[(*ai)], numElems, 0, UINT32_MAX);
+                                if (success)
+                                {
+                                    const double *dArray = &arr->dArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        v_uint32[i] = arr->dArray[(*ai)];
+                                        v_uint32[i] = dArray[i];
                                     }
-                                    break;
-                                case OCREP_PROP_BOOL:
-                                    v_uint32[i] = arr->bArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_STRING:
-                                    if (sscanf(arr->strArray[(*ai)], "%" SCNu32, &v_uint32[i]) != 1)
+                                }
+                                break;
+                            case OCREP_PROP_BOOL:
+                                {
+                                    const bool *bArray = &arr->bArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = false;
+                                        v_uint32[i] = bArray[i];
                                     }
                                     break;
-                                case OCREP_PROP_BYTE_STRING:
-                                case OCREP_PROP_OBJECT:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_NULL:
-                                    break; /* Explicitly not supported */
-                                case OCREP_PROP_ARRAY:
-                                    assert(0); /* Not used as an array value type */
-                                    break;
-                            }
+                                }
+                            case OCREP_PROP_STRING:
+                                for (size_t i = 0; success && i < numElems; ++i)
+                                {
+                                    success = (sscanf(arr->strArray[(*ai) + i], "%" SCNu32, &v_uint32[i]) == 1);
+                                }
+                                break;
+                            case OCREP_PROP_BYTE_STRING:
+                            case OCREP_PROP_OBJECT:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_NULL:
+                                success = false; /* Explicitly not supported */
+                                break;
+                            case OCREP_PROP_ARRAY:
+                                assert(0); /* Not used as an array value type */
+                                break;
                         }
                         if (success)
                         {
+                            (*ai) += numElems;
                             arg->typeId = ajn::ALLJOYN_UINT32_ARRAY;
-                            arg->v_scalarArray.numElements = arr->dimensions[di];
+                            arg->v_scalarArray.numElements = numElems;
                             arg->v_scalarArray.v_uint32 = v_uint32;
                             arg->SetOwnershipFlags(ajn::MsgArg::OwnsData, false);
                         }
@@ -1048,49 +1170,55 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                     }
                 case ajn::ALLJOYN_INT64:
                     {
-                        int64_t *v_int64 = new int64_t[arr->dimensions[di]];
-                        for (size_t i = 0; success && i < arr->dimensions[di]; ++i, ++(*ai))
+                        size_t numElems = arr->dimensions[di];
+                        int64_t *v_int64 = new int64_t[numElems];
+                        switch (arr->type)
                         {
-                            switch (arr->type)
-                            {
-                                case OCREP_PROP_INT:
-                                    v_int64[i] = arr->iArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_DOUBLE:
-                                    success = (floor(arr->dArray[(*ai)]) == arr->dArray[(*ai)]);
-                                    if (success)
-                                    {
-                                        success = (MIN_SAFE_INTEGER <= arr->dArray[(*ai)] && arr->dArray[(*ai)] <= MAX_SAFE_INTEGER);
-                                    }
-                                    if (success)
+                            case OCREP_PROP_INT:
+                                memcpy(v_int64, &arr->iArray[(*ai)], numElems * sizeof(int64_t));
+                                break;
+                            case OCREP_PROP_DOUBLE:
+                                success = IsIntegral(&arr->dArray[(*ai)], numElems, MIN_SAFE_INTEGER, MAX_SAFE_INTEGER);
+                                if (success)
+                                {
+                                    const double *dArray = &arr->dArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        v_int64[i] = arr->dArray[(*ai)];
+                                        v_int64[i] = dArray[i];
                                     }
-                                    break;
-                                case OCREP_PROP_BOOL:
-                                    v_int64[i] = arr->bArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_STRING:
-                                    if (sscanf(arr->strArray[(*ai)], "%" SCNd64, &v_int64[i]) != 1)
+                                }
+                                break;
+                            case OCREP_PROP_BOOL:
+                                {
+                                    const bool *bArray = &arr->bArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = false;
+                                        v_int64[i] = bArray[i];
                                     }
                                     break;
-                                case OCREP_PROP_BYTE_STRING:
-                                case OCREP_PROP_OBJECT:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_NULL:
-                                    break; /* Explicitly not supported */
-                                case OCREP_PROP_ARRAY:
-                                    assert(0); /* Not used as an array value type */
-                                    break;
-                            }
+                                }
+                            case OCREP_PROP_STRING:
+                                for (size_t i = 0; success && i < numElems; ++i)
+                                {
+                                    success = (sscanf(arr->strArray[(*ai) + i], "%" SCNd64, &v_int64[i]) == 1);
+                                }
+                                break;
+                            case OCREP_PROP_BYTE_STRING:
+                            case OCREP_PROP_OBJECT:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_NULL:
+                                success = false; /* Explicitly not supported */
+                                break;
+                            case OCREP_PROP_ARRAY:
+                                assert(0); /* Not used as an array value type */
+                                break;
                         }
                         if (success)
                         {
+                            (*ai) += numElems;
                             arg->typeId = ajn::ALLJOYN_INT64_ARRAY;
-                            arg->v_scalarArray.numElements = arr->dimensions[di];
+                            arg->v_scalarArray.numElements = numElems;
                             arg->v_scalarArray.v_int64 = v_int64;
                             arg->SetOwnershipFlags(ajn::MsgArg::OwnsData, false);
                         }
@@ -1102,53 +1230,63 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                     }
                 case ajn::ALLJOYN_UINT64:
                     {
-                        uint64_t *v_uint64 = new uint64_t[arr->dimensions[di]];
-                        for (size_t i = 0; success && i < arr->dimensions[di]; ++i, ++(*ai))
+                        size_t numElems = arr->dimensions[di];
+                        uint64_t *v_uint64 = new uint64_t[numElems];
+                        switch (arr->type)
                         {
-                            switch (arr->type)
-                            {
-                                case OCREP_PROP_INT:
-                                    success = (0 <= arr->iArray[(*ai)]);
-                                    if (success)
-                                    {
-                                        v_uint64[i] = arr->iArray[(*ai)];
-                                    }
-                                    break;
-                                case OCREP_PROP_DOUBLE:
-                                    success = (floor(arr->dArray[(*ai)]) == arr->dArray[(*ai)]);
-                                    if (success)
+                            case OCREP_PROP_INT:
+                                success = InRange(&arr->iArray[(*ai)], numElems, 0, INT64_MAX);
+                                if (success)
+                                {
+                                    const int64_t *iArray = &arr->iArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = (0 <= arr->dArray[(*ai)] && arr->dArray[(*ai)] <= MAX_SAFE_INTEGER);
+                                        v_uint64[i] = iArray[i];
                                     }
-                                    if (success)
+                                }
+                                break;
+                            case OCREP_PROP_DOUBLE:
+                                success = IsIntegral(&arr->dArray[(*ai)], numElems, 0, MAX_SAFE_INTEGER);
+                                if (success)
+                                {
+                                    const double *dArray = &arr->dArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        v_uint64[i] = arr->dArray[(*ai)];
+                                        v_uint64[i] = dArray[i];
                                     }
-                                    break;
-                                case OCREP_PROP_BOOL:
-                                    v_uint64[i] = arr->bArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_STRING:
-                                    if (sscanf(arr->strArray[(*ai)], "%" SCNu64, &v_uint64[i]) != 1)
+                                }
+                                break;
+                            case OCREP_PROP_BOOL:
+                                {
+                                    const bool *bArray = &arr->bArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = false;
+                                        v_uint64[i] = bArray[i];
                                     }
                                     break;
-                                case OCREP_PROP_BYTE_STRING:
-                                case OCREP_PROP_OBJECT:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_NULL:
-                                    break; /* Explicitly not supported */
-                                case OCREP_PROP_ARRAY:
-                                    assert(0); /* Not used as an array value type */
-                                    break;
-                            }
+                                }
+                            case OCREP_PROP_STRING:
+                                for (size_t i = 0; success && i < numElems; ++i)
+                                {
+                                    success = (sscanf(arr->strArray[(*ai) + i], "%" SCNu64, &v_uint64[i]) == 1);
+                                }
+                                break;
+                            case OCREP_PROP_BYTE_STRING:
+                            case OCREP_PROP_OBJECT:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_NULL:
+                                success = false; /* Explicitly not supported */
+                                break;
+                            case OCREP_PROP_ARRAY:
+                                assert(0); /* Not used as an array value type */
+                                break;
                         }
                         if (success)
                         {
+                            (*ai) += numElems;
                             arg->typeId = ajn::ALLJOYN_UINT64_ARRAY;
-                            arg->v_scalarArray.numElements = arr->dimensions[di];
+                            arg->v_scalarArray.numElements = numElems;
                             arg->v_scalarArray.v_uint64 = v_uint64;
                             arg->SetOwnershipFlags(ajn::MsgArg::OwnsData, false);
                         }
@@ -1160,46 +1298,55 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                     }
                 case ajn::ALLJOYN_DOUBLE:
                     {
-                        double *v_double = new double[arr->dimensions[di]];
-                        for (size_t i = 0; success && i < arr->dimensions[di]; ++i, ++(*ai))
+                        size_t numElems = arr->dimensions[di];
+                        double *v_double = new double[numElems];
+                        switch (arr->type)
                         {
-                            switch (arr->type)
-                            {
-                                case OCREP_PROP_INT:
-                                    success = (MIN_SAFE_INTEGER <= arr->iArray[(*ai)] && arr->iArray[(*ai)] <= MAX_SAFE_INTEGER);
-                                    if (success)
+                            case OCREP_PROP_INT:
+                                success = InRange(&arr->iArray[(*ai)], numElems, MIN_SAFE_INTEGER, MAX_SAFE_INTEGER);
+                                if (success)
+                                {
+                                    const int64_t *iArray = &arr->iArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        arg->typeId = ajn::ALLJOYN_DOUBLE;
-                                        arg->v_double = arr->iArray[(*ai)];
+                                        v_double[i] = iArray[i];
                                     }
-                                    break;
-                                case OCREP_PROP_DOUBLE:
-                                    v_double[i] = arr->dArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_BOOL:
-                                    v_double[i] = arr->bArray[(*ai)];
-                                    break;
-                                case OCREP_PROP_STRING:
-                                    if (sscanf(arr->strArray[(*ai)], "%lf", &v_double[i]) != 1)
+                                }
+                                break;
+                            case OCREP_PROP_DOUBLE:
+                                memcpy(v_double, &arr->dArray[(*ai)], numElems * sizeof(double));
+                                break;
+                            case OCREP_PROP_BOOL:
+                                {
+                                    const bool *bArray = &arr->bArray[(*ai)];
+                                    for (size_t i = 0; i < numElems; ++i)
                                     {
-                                        success = false;
+                                        v_double[i] = bArray[i];
                                     }
                                     break;
-                                case OCREP_PROP_BYTE_STRING:
-                                case OCREP_PROP_OBJECT:
-                                    success = false; /* Loss of information */
-                                    break;
-                                case OCREP_PROP_NULL:
-                                    break; /* Explicitly not supported */
-                                case OCREP_PROP_ARRAY:
-                                    assert(0); /* Not used as an array value type */
-                                    break;
-                            }
+                                }
+                            case OCREP_PROP_STRING:
+                                for (size_t i = 0; success && i < numElems; ++i)
+                                {
+                                    success = (sscanf(arr->strArray[(*ai) + i], "%lf", &v_double[i]) == 1);
+                                }
+                                break;
+                            case OCREP_PROP_BYTE_STRING:
+                            case OCREP_PROP_OBJECT:
+                                success = false; /* Loss of information */
+                                break;
+                            case OCREP_PROP_NULL:
+                                success = false; /* Explicitly not supported */
+                                break;
+                            case OCREP_PROP_ARRAY:
+                                assert(0); /* Not used as an array value type */
+                                break;
                         }
                         if (success)
                         {
+                            (*ai) += numElems;
                             arg->typeId = ajn::ALLJOYN_DOUBLE_ARRAY;
-                            arg->v_scalarArray.numElements = arr->dimensions[di];
+                            arg->v_scalarArray.numElements = numElems;
                             arg->v_scalarArray.v_double = v_double;
                             arg->SetOwnershipFlags(ajn::MsgArg::OwnsData, false);
                         }
@@ -1234,7 +1381,7 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                                 case OCREP_PROP_NULL: break; /* Explicitly not supported */
                                 case OCREP_PROP_ARRAY: assert(0); break; /* Not used as an array value type */
                             }
-                            success = ToAJMsgArg(&elems[i], &signature[1], &arrValue);
+                            success = ToAJMsgArg(&elems[i], &signature[1], &arrValue, types);
                         }
                         if (success)
                         {
@@ -1257,7 +1404,7 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                         ajn::MsgArg *elems = new ajn::MsgArg[numElems];
                         for (size_t i = 0; success && i < numElems; ++i)
                         {
-                            success = ToAJMsgArg(&elems[i], &signature[1], arr, ai, di + 1);
+                            success = ToAJMsgArg(&elems[i], &signature[1], arr, ai, di + 1, types);
                         }
                         if (success)
                         {
@@ -1293,7 +1440,7 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                                     OCRepPayloadValue arrValue;
                                     arrValue.type = arr->type;
                                     arrValue.obj = arr->objArray[(*ai)];
-                                    success = ToAJMsgArg(&elems[i], &signature[1], &arrValue);
+                                    success = ToAJMsgArg(&elems[i], &signature[1], &arrValue, types);
                                 }
                                 if (success)
                                 {
@@ -1337,7 +1484,7 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                                     OCRepPayloadValue arrValue;
                                     arrValue.type = arr->type;
                                     arrValue.obj = arr->objArray[(*ai)];
-                                    success = ToAJMsgArg(&elems[i], &signature[1], &arrValue);
+                                    success = ToAJMsgArg(&elems[i], &signature[1], &arrValue, types);
                                 }
                                 if (success)
                                 {
@@ -1374,6 +1521,12 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                             break;
                         case OCREP_PROP_OBJECT:
                             {
+                                const Types::Fields *fields = types ? types->GetFields(&signature[1]) : NULL;
+                                if (!fields)
+                                {
+                                    success = false;
+                                    break;
+                                }
                                 size_t numElems = arr->dimensions[di];
                                 ajn::MsgArg *elems = new ajn::MsgArg[numElems];
                                 for (size_t i = 0; success && i < numElems; ++i, ++(*ai))
@@ -1381,14 +1534,14 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
                                     OCRepPayloadValue arrValue;
                                     arrValue.type = arr->type;
                                     arrValue.obj = arr->objArray[(*ai)];
-                                    success = ToAJMsgArg(&elems[i], &signature[1], &arrValue);
+                                    success = ToAJMsgArg(&elems[i], &signature[1], &arrValue, types);
                                 }
                                 if (success)
                                 {
                                     arg->typeId = ajn::ALLJOYN_ARRAY;
                                     std::string elemSig = "(";
-                                    for (std::vector<Types::Field>::iterator field = Types::m_structs[&signature[1]].begin();
-                                         field != Types::m_structs[&signature[1]].end(); ++field)
+                                    for (Types::Fields::const_iterator field = fields->begin();
+                                         field != fields->end(); ++field)
                                     {
                                         elemSig += field->m_signature;
                                     }
@@ -1424,7 +1577,7 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
             success = false;
             break;
         case ajn::ALLJOYN_VARIANT:
-            success = ToAJMsgArg(arg, "av", arr, ai, di);
+            success = ToAJMsgArg(arg, "av", arr, ai, di, types);
             break;
         case ajn::ALLJOYN_DICT_ENTRY_OPEN:
             success = false; /* Loss of information */
@@ -1436,12 +1589,9 @@ static bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature,
     return success;
 }
 
-bool ToAJMsgArg(ajn::MsgArg *arg,
-                const char *signature, OCRepPayloadValue *value)
+static bool ToAJMsgArgCompleteType(ajn::MsgArg *arg, const std::string &sig,
+                                   OCRepPayloadValue *value, const Types *types)
 {
-    const char *argSignature = signature;
-    ParseCompleteType(signature);
-    std::string sig(argSignature, signature - argSignature);
     bool success = true;
     switch (value->type)
     {
@@ -1531,11 +1681,11 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
                     arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
                     if (value->i < INT32_MIN || INT32_MAX < value->i)
                     {
-                        success = ToAJMsgArg(arg->v_variant.val, "x", value);
+                        success = ToAJMsgArg(arg->v_variant.val, "x", value, types);
                     }
                     else
                     {
-                        success = ToAJMsgArg(arg->v_variant.val, "i", value);
+                        success = ToAJMsgArg(arg->v_variant.val, "i", value, types);
                     }
                     break;
                 case ajn::ALLJOYN_DICT_ENTRY_OPEN:
@@ -1655,7 +1805,7 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
                     arg->typeId = ajn::ALLJOYN_VARIANT;
                     arg->v_variant.val = new ajn::MsgArg();
                     arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
-                    success = ToAJMsgArg(arg->v_variant.val, "d", value);
+                    success = ToAJMsgArg(arg->v_variant.val, "d", value, types);
                     break;
                 case ajn::ALLJOYN_DICT_ENTRY_OPEN:
                     success = false; /* Loss of information */
@@ -1731,7 +1881,7 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
                     arg->typeId = ajn::ALLJOYN_VARIANT;
                     arg->v_variant.val = new ajn::MsgArg();
                     arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
-                    success = ToAJMsgArg(arg->v_variant.val, "b", value);
+                    success = ToAJMsgArg(arg->v_variant.val, "b", value, types);
                     break;
                 case ajn::ALLJOYN_DICT_ENTRY_OPEN:
                     success = false; /* Loss of information */
@@ -1867,7 +2017,7 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
                     arg->typeId = ajn::ALLJOYN_VARIANT;
                     arg->v_variant.val = new ajn::MsgArg();
                     arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
-                    success = ToAJMsgArg(arg->v_variant.val, "s", value);
+                    success = ToAJMsgArg(arg->v_variant.val, "s", value, types);
                     break;
                 case ajn::ALLJOYN_DICT_ENTRY_OPEN:
                     success = false; /* Loss of information */
@@ -2056,7 +2206,7 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
                     arg->typeId = ajn::ALLJOYN_VARIANT;
                     arg->v_variant.val = new ajn::MsgArg();
                     arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
-                    success = ToAJMsgArg(arg->v_variant.val, "ay", value);
+                    success = ToAJMsgArg(arg->v_variant.val, "ay", value, types);
                     break;
                 case ajn::ALLJOYN_DICT_ENTRY_OPEN:
                     success = false; /* Loss of information */
@@ -2138,10 +2288,10 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
                                     elem->v_variant.val->v_dictEntry.key = new ajn::MsgArg();
                                     elem->v_variant.val->v_dictEntry.val = new ajn::MsgArg();
                                     elem->v_variant.val->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
-                                    success = ToAJMsgArg(elem->v_variant.val->v_dictEntry.key, "s", &k);
+                                    success = ToAJMsgArg(elem->v_variant.val->v_dictEntry.key, "s", &k, types);
                                     if (success)
                                     {
-                                        success = ToAJMsgArg(elem->v_variant.val->v_dictEntry.val, "v", v);
+                                        success = ToAJMsgArg(elem->v_variant.val->v_dictEntry.val, "v", v, types);
                                     }
                                     ++elem;
                                 }
@@ -2187,10 +2337,10 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
                                     entry->v_dictEntry.key = new ajn::MsgArg();
                                     entry->v_dictEntry.val = new ajn::MsgArg();
                                     entry->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
-                                    success = ToAJMsgArg(entry->v_dictEntry.key, keySig.c_str(), &k);
+                                    success = ToAJMsgArg(entry->v_dictEntry.key, keySig.c_str(), &k, types);
                                     if (success)
                                     {
-                                        success = ToAJMsgArg(entry->v_dictEntry.val, valSig.c_str(), v);
+                                        success = ToAJMsgArg(entry->v_dictEntry.val, valSig.c_str(), v, types);
                                     }
                                     ++entry;
                                 }
@@ -2238,7 +2388,7 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
                             {
                                 if (!strcmp(v->name, name))
                                 {
-                                    success = ToAJMsgArg(member, memberSig.c_str(), v);
+                                    success = ToAJMsgArg(member, memberSig.c_str(), v, types);
                                     ++member;
                                     break;
                                 }
@@ -2261,25 +2411,31 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
                     arg->typeId = ajn::ALLJOYN_VARIANT;
                     arg->v_variant.val = new ajn::MsgArg();
                     arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
-                    success = ToAJMsgArg(arg->v_variant.val, "a{sv}", value);
+                    success = ToAJMsgArg(arg->v_variant.val, "a{sv}", value, types);
                     break;
                 case ajn::ALLJOYN_DICT_ENTRY_OPEN:
                     success = false; /* Loss of information */
                     break;
                 case '[':
                     {
-                        size_t numMembers = Types::m_structs[sig].size();
+                        const Types::Fields *fields = types ? types->GetFields(sig) : NULL;
+                        if (!fields)
+                        {
+                            success = false;
+                            break;
+                        }
+                        size_t numMembers = fields->size();
                         ajn::MsgArg *members = new ajn::MsgArg[numMembers];
                         ajn::MsgArg *member = members;
-                        for (std::vector<Types::Field>::iterator field = Types::m_structs[sig].begin(); success
-                             && field != Types::m_structs[sig].end(); ++field)
+                        for (Types::Fields::const_iterator field = fields->begin(); success
+                             && field != fields->end(); ++field)
                         {
                             success = false;
                             for (OCRepPayloadValue *v = value->obj->values; v; v = v->next)
                             {
                                 if (!strcmp(v->name, field->m_name.c_str()))
                                 {
-                                    success = ToAJMsgArg(member, field->m_signature.c_str(), v);
+                                    success = ToAJMsgArg(member, field->m_signature.c_str(), v, types);
                                     ++member;
                                     break;
                                 }
@@ -2306,9 +2462,328 @@ bool ToAJMsgArg(ajn::MsgArg *arg,
         case OCREP_PROP_ARRAY:
             {
                 size_t i = 0;
-                success = ToAJMsgArg(arg, sig.c_str(), &value->arr, &i, 0);
+                success = ToAJMsgArg(arg, sig.c_str(), &value->arr, &i, 0, types);
+                break;
+            }
+    }
+    return success;
+}
+
+bool ToAJMsgArg(ajn::MsgArg *arg,
+                const char *signature, OCRepPayloadValue *value, const Types *types)
+{
+    const char *argSignature = signature;
+    ParseCompleteType(signature);
+    std::string sig(argSignature, signature - argSignature);
+    return ToAJMsgArgCompleteType(arg, sig, value, types);
+}
+
+/* Deeper than this is not a valid AllJoyn signature or is a recursive named type. */
+static const uint8_t MAX_PLAN_DEPTH = 64;
+
+static bool Compile(std::vector<TranslationPlan::Op> &ops, const char *&signature,
+                    const char *name, const Types *types, uint8_t depth)
+{
+    if (depth > MAX_PLAN_DEPTH)
+    {
+        return false;
+    }
+    const char *begin = signature;
+    size_t op = ops.size();
+    ops.push_back(TranslationPlan::Op());
+    ops[op].m_typeId = *signature;
+    ops[op].m_name = name;
+    bool success = true;
+    switch (*signature++)
+    {
+        case ajn::ALLJOYN_BOOLEAN:
+        case ajn::ALLJOYN_BYTE:
+        case ajn::ALLJOYN_INT16:
+        case ajn::ALLJOYN_UINT16:
+        case ajn::ALLJOYN_INT32:
+        case ajn::ALLJOYN_UINT32:
+        case ajn::ALLJOYN_INT64:
+        case ajn::ALLJOYN_UINT64:
+        case ajn::ALLJOYN_DOUBLE:
+        case ajn::ALLJOYN_HANDLE:
+        case ajn::ALLJOYN_STRING:
+        case ajn::ALLJOYN_OBJECT_PATH:
+        case ajn::ALLJOYN_SIGNATURE:
+        case ajn::ALLJOYN_VARIANT:
+            break;
+        case ajn::ALLJOYN_ARRAY:
+            success = Compile(ops, signature, "", types, depth + 1);
+            break;
+        case ajn::ALLJOYN_STRUCT_OPEN:
+            for (size_t i = 0; success && *signature != ajn::ALLJOYN_STRUCT_CLOSE; ++i)
+            {
+                char fieldName[16];
+                snprintf(fieldName, 16, "%zu", i);
+                success = Compile(ops, signature, fieldName, types, depth + 1);
+            }
+            if (success)
+            {
+                ++signature;
+            }
+            break;
+        case ajn::ALLJOYN_DICT_ENTRY_OPEN:
+            success = Compile(ops, signature, "", types, depth + 1) &&
+                      Compile(ops, signature, "", types, depth + 1) &&
+                      (*signature++ == ajn::ALLJOYN_DICT_ENTRY_CLOSE);
+            break;
+        case '[':
+            {
+                const char *close = strchr(signature, ']');
+                if (!close)
+                {
+                    success = false;
+                    break;
+                }
+                signature = close + 1;
+                const Types::Fields *fields = types ?
+                                              types->GetFields(std::string(begin, signature - begin)) : NULL;
+                if (!fields)
+                {
+                    success = false;
+                    break;
+                }
+                for (Types::Fields::const_iterator field = fields->begin();
+                     success && field != fields->end(); ++field)
+                {
+                    const char *fieldSignature = field->m_signature.c_str();
+                    success = Compile(ops, fieldSignature, field->m_name.c_str(), types, depth + 1) &&
+                              (*fieldSignature == '\0');
+                }
+                break;
+            }
+        default:
+            success = false;
+            break;
+    }
+    if (success)
+    {
+        ops[op].m_signature.assign(begin, signature - begin);
+        ops[op].m_end = ops.size();
+    }
+    return success;
+}
+
+bool TranslationPlan::Compile(const char *signature, const std::shared_ptr<const Types> &types)
+{
+    m_ops.clear();
+    m_types = types;
+    bool success = ::Compile(m_ops, signature, "", types.get(), 0);
+    if (!success)
+    {
+        m_ops.clear();
+        m_types.reset();
+    }
+    return success;
+}
+
+static bool ToOCPayload(OCRepPayload *payload, const char *name, const ajn::MsgArg *arg,
+                        const TranslationPlan &plan, size_t op)
+{
+    const std::vector<TranslationPlan::Op> &ops = plan.m_ops;
+    bool success = false;
+    switch (ops[op].m_typeId)
+    {
+        case ajn::ALLJOYN_ARRAY:
+            if (ops[op + 1].m_typeId == ajn::ALLJOYN_DICT_ENTRY_OPEN)
+            {
+                OCRepPayload *value = OCRepPayloadCreate();
+                if (!value)
+                {
+                    break;
+                }
+                success = true;
+                for (size_t i = 0; success && i < arg->v_array.GetNumElements(); ++i)
+                {
+                    success = ToOCPayload(value, NULL, &arg->v_array.GetElements()[i], plan, op + 1);
+                }
+                if (success)
+                {
+                    success = OCRepPayloadSetPropObjectAsOwner(payload, name, value);
+                }
+                else
+                {
+                    OCRepPayloadDestroy(value);
+                }
+            }
+            else
+            {
+                success = ToOCPayload(payload, name, arg, ops[op].m_signature.c_str(),
+                                      plan.m_types.get());
+            }
+            break;
+        case ajn::ALLJOYN_STRUCT_OPEN:
+        case '[':
+            {
+                OCRepPayload *value = OCRepPayloadCreate();
+                if (!value)
+                {
+                    break;
+                }
+                success = true;
+                size_t field = op + 1;
+                for (size_t i = 0; success && i < arg->v_struct.numMembers; ++i)
+                {
+                    success = (field < ops[op].m_end) &&
+                              ToOCPayload(value, ops[field].m_name.c_str(), &arg->v_struct.members[i],
+                                          plan, field);
+                    field = ops[field].m_end;
+                }
+                if (success)
+                {
+                    success = OCRepPayloadSetPropObjectAsOwner(payload, name, value);
+                }
+                else
+                {
+                    OCRepPayloadDestroy(value);
+                }
+                break;
+            }
+        case ajn::ALLJOYN_DICT_ENTRY_OPEN:
+            {
+                size_t key = op + 1;
+                char keyNameBuf[64];
+                const char *keyName = GetKeyName(arg->v_dictEntry.key, ops[key].m_typeId, keyNameBuf);
+                if (keyName)
+                {
+                    success = ToOCPayload(payload, keyName, arg->v_dictEntry.val, plan, ops[key].m_end);
+                }
+                break;
+            }
+        default:
+            /* Nothing to parse in the remaining types */
+            success = ToOCPayload(payload, name, arg, ops[op].m_signature.c_str(),
+                                  plan.m_types.get());
+            break;
+    }
+    return success;
+}
+
+bool ToOCPayload(OCRepPayload *payload, const char *name, const ajn::MsgArg *arg,
+                 const TranslationPlan &plan)
+{
+    assert(!plan.m_ops.empty());
+    return ToOCPayload(payload, name, arg, plan, 0);
+}
+
+static bool ToAJMsgArg(ajn::MsgArg *arg, const TranslationPlan &plan, size_t op,
+                       OCRepPayloadValue *value);
+
+static bool ToAJStruct(ajn::MsgArg *arg, const TranslationPlan &plan, size_t op,
+                       OCRepPayloadValue *value)
+{
+    const std::vector<TranslationPlan::Op> &ops = plan.m_ops;
+    size_t numMembers = 0;
+    for (size_t field = op + 1; field < ops[op].m_end; field = ops[field].m_end)
+    {
+        ++numMembers;
+    }
+    ajn::MsgArg *members = new ajn::MsgArg[numMembers];
+    bool success = true;
+    size_t field = op + 1;
+    for (size_t i = 0; success && i < numMembers; ++i)
+    {
+        success = false;
+        for (OCRepPayloadValue *v = value->obj->values; v; v = v->next)
+        {
+            if (ops[field].m_name == v->name)
+            {
+                success = ToAJMsgArg(&members[i], plan, field, v);
                 break;
             }
+        }
+        field = ops[field].m_end;
+    }
+    if (success)
+    {
+        arg->typeId = ajn::ALLJOYN_STRUCT;
+        arg->v_struct.numMembers = numMembers;
+        arg->v_struct.members = members;
+        arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
+    }
+    else
+    {
+        delete[] members;
+    }
+    return success;
+}
+
+static bool ToAJDictionary(ajn::MsgArg *arg, const TranslationPlan &plan,
+                           size_t op, OCRepPayloadValue *value)
+{
+    const std::vector<TranslationPlan::Op> &ops = plan.m_ops;
+    size_t entryOp = op + 1;
+    size_t keyOp = entryOp + 1;
+    size_t valOp = ops[keyOp].m_end;
+    size_t numEntries = 0;
+    for (OCRepPayloadValue *v = value->obj->values; v; v = v->next)
+    {
+        ++numEntries;
+    }
+    ajn::MsgArg *entries = new ajn::MsgArg[numEntries];
+    ajn::MsgArg *entry = entries;
+    bool success = true;
+    for (OCRepPayloadValue *v = value->obj->values; success && v; v = v->next)
+    {
+        OCRepPayloadValue k;
+        memset(&k, 0, sizeof(k));
+        k.type = OCREP_PROP_STRING;
+        k.str = v->name;
+        entry->typeId = ajn::ALLJOYN_DICT_ENTRY;
+        entry->v_dictEntry.key = new ajn::MsgArg();
+        entry->v_dictEntry.val = new ajn::MsgArg();
+        entry->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
+        success = ToAJMsgArg(entry->v_dictEntry.key, plan, keyOp, &k) &&
+                  ToAJMsgArg(entry->v_dictEntry.val, plan, valOp, v);
+        ++entry;
+    }
+    if (success)
+    {
+        arg->typeId = ajn::ALLJOYN_ARRAY;
+        success = (arg->v_array.SetElements(ops[entryOp].m_signature.c_str(), numEntries,
+                   entries) == ER_OK);
+    }
+    if (success)
+    {
+        arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
+    }
+    else
+    {
+        delete[] entries;
     }
     return success;
 }
+
+static bool ToAJMsgArg(ajn::MsgArg *arg, const TranslationPlan &plan, size_t op,
+                       OCRepPayloadValue *value)
+{
+    const std::vector<TranslationPlan::Op> &ops = plan.m_ops;
+    if (value->type == OCREP_PROP_OBJECT)
+    {
+        switch (ops[op].m_typeId)
+        {
+            case ajn::ALLJOYN_STRUCT_OPEN:
+            case '[':
+                return ToAJStruct(arg, plan, op, value);
+            case ajn::ALLJOYN_ARRAY:
+                if (ops[op + 1].m_typeId == ajn::ALLJOYN_DICT_ENTRY_OPEN)
+                {
+                    return ToAJDictionary(arg, plan, op, value);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return ToAJMsgArgCompleteType(arg, ops[op].m_signature, value, plan.m_types.get());
+}
+
+bool ToAJMsgArg(ajn::MsgArg *arg, const TranslationPlan &plan, OCRepPayloadValue *value)
+{
+    assert(!plan.m_ops.empty());
+    return ToAJMsgArg(arg, plan, 0, value);
+}
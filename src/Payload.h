@@ -25,25 +25,68 @@
 #include <alljoyn/MsgArg.h>
 #include "octypes.h"
 #include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 const int64_t MAX_SAFE_INTEGER = 9007199254740991;
 const int64_t MIN_SAFE_INTEGER = -9007199254740991;
 
-struct Types
+/*
+ * The named struct types, e.g. "[Name]", declared by the org.alljoyn.Bus.Struct annotations of
+ * an object's interfaces.  A Types is not modified once constructed so it may be read from any
+ * thread without locking; a rediscovered object gets a new one instead.
+ */
+class Types
 {
-    struct Field
+    public:
+        struct Field
+        {
+            Field(std::string name, std::string signature)
+                : m_name(name), m_signature(signature) { }
+            std::string m_name;
+            std::string m_signature;
+        };
+        typedef std::vector<Field> Fields;
+        typedef std::unordered_map<std::string, Fields> Structs;
+
+        Types(const Structs &structs) : m_structs(structs) { }
+        /* Returns NULL when name is not a declared struct type. */
+        const Fields *GetFields(const std::string &name) const;
+
+    private:
+        const Structs m_structs;
+};
+
+/*
+ * A complete type compiled once so that translating values of it does not parse the signature.
+ * The ops are the type tree in pre-order.  Named types are resolved from the Types given to
+ * Compile(), which the plan keeps for the types it still translates from signatures.
+ */
+struct TranslationPlan
+{
+    struct Op
     {
-        Field(std::string name, std::string signature) : m_name(name), m_signature(signature) { }
-        std::string m_name;
-        std::string m_signature;
+        char m_typeId; /* First character of m_signature */
+        size_t m_end; /* Index of the op following this op and its children */
+        std::string m_signature; /* Complete type of this op */
+        std::string m_name; /* Property name of a struct field */
     };
+    std::vector<Op> m_ops;
+    std::shared_ptr<const Types> m_types;
 
-    static std::map<std::string, std::vector<Field>> m_structs;
+    /* Compiles the complete type at the beginning of signature. */
+    bool Compile(const char *signature, const std::shared_ptr<const Types> &types);
 };
 
+/* Named types in signature are looked up in types. */
+bool ToOCPayload(OCRepPayload *payload, const char *name, const ajn::MsgArg *arg,
+                 const char *signature, const Types *types = NULL);
 bool ToOCPayload(OCRepPayload *payload, const char *name, const ajn::MsgArg *arg,
-                 const char *signature);
-bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature, OCRepPayloadValue *value);
+                 const TranslationPlan &plan);
+bool ToAJMsgArg(ajn::MsgArg *arg, const char *signature, OCRepPayloadValue *value,
+                const Types *types = NULL);
+bool ToAJMsgArg(ajn::MsgArg *arg, const TranslationPlan &plan, OCRepPayloadValue *value);
 
 #endif
@@ -0,0 +1,79 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "PendingChanges.h"
+
+#include "TaskQueue.h"
+#include <algorithm>
+
+void PendingChanges::SetWindow(uint32_t windowMs, uint32_t maxLatencyMs)
+{
+    m_windowMs = windowMs;
+    m_maxLatencyMs = maxLatencyMs;
+}
+
+uint64_t PendingChanges::Add(const char *ifaceName, const ajn::MsgArg *dict, uint64_t now)
+{
+    Changes &changes = m_changes[ifaceName];
+    if (changes.m_values.empty())
+    {
+        changes.m_firstTick = now;
+    }
+    changes.m_lastTick = now;
+    size_t numEntries = dict->v_array.GetNumElements();
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        const ajn::MsgArg *entry = &dict->v_array.GetElements()[i];
+        changes.m_values[entry->v_dictEntry.key->v_string.str] =
+                *entry->v_dictEntry.val->v_variant.val;
+    }
+    if (m_isFlushScheduled)
+    {
+        return TaskQueue::NEVER;
+    }
+    m_isFlushScheduled = true;
+    return GetFlushTick(changes);
+}
+
+uint64_t PendingChanges::Flush(uint64_t now, std::map<std::string, Values> &due)
+{
+    uint64_t nextTick = TaskQueue::NEVER;
+    std::map<std::string, Changes>::iterator it = m_changes.begin();
+    while (it != m_changes.end())
+    {
+        uint64_t tick = GetFlushTick(it->second);
+        if (tick > now)
+        {
+            nextTick = std::min(nextTick, tick);
+            ++it;
+            continue;
+        }
+        due[it->first].swap(it->second.m_values);
+        it = m_changes.erase(it);
+    }
+    m_isFlushScheduled = (nextTick != TaskQueue::NEVER);
+    return nextTick;
+}
+
+uint64_t PendingChanges::GetFlushTick(const Changes &changes) const
+{
+    uint32_t maxLatencyMs = std::max(m_maxLatencyMs, m_windowMs);
+    return std::min(changes.m_lastTick + m_windowMs, changes.m_firstTick + maxLatencyMs);
+}
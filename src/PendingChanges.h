@@ -0,0 +1,74 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _PENDINGCHANGES_H
+#define _PENDINGCHANGES_H
+
+#include <inttypes.h>
+#include <alljoyn/MsgArg.h>
+#include <map>
+#include <string>
+
+/*
+ * The PropertiesChanged signals of the interfaces of an object coalesced into one notification
+ * of the latest values of each interface.  Changes are due windowMs after the last of them, or
+ * maxLatencyMs (or windowMs if greater) after the first of them, whichever is earlier.
+ *
+ * Not thread-safe, callers are expected to provide their own locking.
+ */
+class PendingChanges
+{
+    public:
+        typedef std::map<std::string, ajn::MsgArg> Values; /* Latest value of each property */
+
+        PendingChanges() : m_windowMs(0), m_maxLatencyMs(0), m_isFlushScheduled(false) { }
+
+        /* The default windowMs of 0 does not coalesce changes. */
+        void SetWindow(uint32_t windowMs, uint32_t maxLatencyMs);
+        bool IsCoalescing() const { return m_windowMs != 0; }
+        /*
+         * Adds the changes of dict, an a{sv}, received at now.  Returns the tick to call Flush()
+         * at, or TaskQueue::NEVER when a call is already scheduled.
+         */
+        uint64_t Add(const char *ifaceName, const ajn::MsgArg *dict, uint64_t now);
+        /* Drops the changes of ifaceName, e.g. when its current values have been fetched. */
+        void Erase(const char *ifaceName) { m_changes.erase(ifaceName); }
+        /*
+         * Moves the changes due by now into due, indexed by interface name.  Returns the tick the
+         * next changes are due at, or TaskQueue::NEVER when there are none.
+         */
+        uint64_t Flush(uint64_t now, std::map<std::string, Values> &due);
+
+    private:
+        struct Changes
+        {
+            Values m_values;
+            uint64_t m_firstTick; /* When the first change was received */
+            uint64_t m_lastTick; /* When the last change was received */
+        };
+        std::map<std::string, Changes> m_changes; /* Indexed by interface name */
+        uint32_t m_windowMs;
+        uint32_t m_maxLatencyMs;
+        bool m_isFlushScheduled; /* Flush() will be called */
+
+        uint64_t GetFlushTick(const Changes &changes) const;
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include "Presence.h"
 
 #include "Plugin.h"
+#include <algorithm>
 
 AllJoynPresence::AllJoynPresence(ajn::BusAttachment *bus, const std::string &name)
     : Presence(name), m_bus(bus), m_lastTick(time(NULL)), m_tries(0), m_state(IDLE)
@@ -88,7 +89,8 @@ void AllJoynPresence::PingCB(QStatus status, void *context)
 }
 
 OCPresence::OCPresence(const char *di, time_t periodSecs)
-    : Presence(di), m_periodSecs(periodSecs), m_lastTick(time(NULL))
+    : Presence(di), m_periodSecs(periodSecs), m_lastTick(time(NULL)),
+      m_deadline(m_lastTick + (periodSecs * RETRIES))
 {
     LOG(LOG_INFO, "[%p]", this);
 }
@@ -101,11 +103,20 @@ OCPresence::~OCPresence()
 bool OCPresence::IsPresent()
 {
     std::lock_guard<std::mutex> lock(m_mutex);
-    return (time(NULL) - m_lastTick) <= (m_periodSecs * RETRIES);
+    return time(NULL) <= m_deadline;
 }
 
 void OCPresence::Seen()
 {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_lastTick = time(NULL);
+    m_deadline = m_lastTick + (m_periodSecs * RETRIES);
+}
+
+void OCPresence::SetPeriod(time_t periodSecs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_periodSecs = periodSecs;
+    /* A shorter period only applies from the next Seen(), the device may not have been asked */
+    m_deadline = std::max(m_deadline, m_lastTick + (m_periodSecs * RETRIES));
 }
@@ -35,6 +35,8 @@ class Presence
         virtual ~Presence() { }
         virtual bool IsPresent() = 0;
         virtual void Seen() = 0;
+        /* Called when the expected interval between calls to Seen() changes. */
+        virtual void SetPeriod(time_t periodSecs) { (void) periodSecs; }
         virtual std::string GetId() const { return m_id; }
     private:
         std::string m_id;
@@ -71,13 +73,15 @@ class OCPresence : public Presence
 
         virtual bool IsPresent();
         virtual void Seen();
+        virtual void SetPeriod(time_t periodSecs);
 
     private:
         static const uint8_t RETRIES = 3;
 
-        const time_t m_periodSecs;
+        time_t m_periodSecs;
         std::mutex m_mutex;
         time_t m_lastTick;
+        time_t m_deadline; /* Absent after this tick */
 };
 
 #endif
@@ -0,0 +1,77 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "PropertyCache.h"
+
+const size_t PropertyCache::BORROW_MIN_BYTES;
+
+void PropertyCache::Update(ajn::Message &msg, const ajn::MsgArg *dict)
+{
+    size_t numEntries = dict->v_array.GetNumElements();
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        const ajn::MsgArg *entry = &dict->v_array.GetElements()[i];
+        const char *name = entry->v_dictEntry.key->v_string.str;
+        const ajn::MsgArg *value = entry->v_dictEntry.val->v_variant.val;
+        std::map<std::string, Value>::iterator it = m_values.find(name);
+        if (it == m_values.end())
+        {
+            it = m_values.insert(std::make_pair(name, Value(*m_bus))).first;
+        }
+        Value &cached = it->second;
+        if ((value->typeId == ajn::ALLJOYN_BYTE_ARRAY) &&
+                (value->v_scalarArray.numElements >= BORROW_MIN_BYTES))
+        {
+            cached.m_copy.Clear();
+            cached.m_msg = msg;
+            cached.m_value = value;
+            cached.m_isBorrowed = true;
+        }
+        else
+        {
+            if (cached.m_isBorrowed)
+            {
+                /* Release the message of the previous value */
+                cached.m_msg = ajn::Message(*m_bus);
+                cached.m_value = NULL;
+                cached.m_isBorrowed = false;
+            }
+            cached.m_copy = *value;
+        }
+    }
+}
+
+const ajn::MsgArg *PropertyCache::GetValue(const char *name) const
+{
+    std::map<std::string, Value>::const_iterator it = m_values.find(name);
+    return (it == m_values.end()) ? NULL : it->second.GetValue();
+}
+
+void PropertyCache::GetValues(ajn::MsgArg *dict, std::vector<ajn::MsgArg> &entries) const
+{
+    entries.resize(m_values.size());
+    size_t i = 0;
+    for (std::map<std::string, Value>::const_iterator it = m_values.begin(); it != m_values.end();
+         ++it)
+    {
+        entries[i++].Set("{sv}", it->first.c_str(), const_cast<ajn::MsgArg *>(it->second.GetValue()));
+    }
+    dict->Set("a{sv}", entries.size(), entries.empty() ? NULL : &entries[0]);
+}
@@ -0,0 +1,75 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _PROPERTYCACHE_H
+#define _PROPERTYCACHE_H
+
+#include <inttypes.h>
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/MsgArg.h>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+ * The values of the properties of an interface, from a GetAll reply and updated by
+ * PropertiesChanged signals.
+ *
+ * Large byte arrays (firmware chunks, images) are referenced in the message they arrived in
+ * rather than copied, the message is kept for as long as they are cached.
+ *
+ * Not thread-safe, callers are expected to provide their own locking.
+ */
+class PropertyCache
+{
+    public:
+        static const size_t BORROW_MIN_BYTES = 4096; /* Smaller byte arrays are copied */
+
+        PropertyCache(ajn::BusAttachment *bus, uint64_t tick) : m_bus(bus), m_tick(tick) { }
+
+        /* Sets or adds the values of dict, an a{sv} arg of msg. */
+        void Update(ajn::Message &msg, const ajn::MsgArg *dict);
+        /* Returns the value of the property or NULL when it is not cached. */
+        const ajn::MsgArg *GetValue(const char *name) const;
+        /*
+         * Sets dict to an a{sv} of the values, with its entries held in entries.  The values are
+         * referenced rather than copied, so dict is only valid until the cache is updated.
+         */
+        void GetValues(ajn::MsgArg *dict, std::vector<ajn::MsgArg> &entries) const;
+        bool IsEmpty() const { return m_values.empty(); }
+        uint64_t GetTick() const { return m_tick; } /* When the values were fetched */
+
+    private:
+        struct Value
+        {
+            ajn::MsgArg m_copy;
+            ajn::Message m_msg; /* Holds m_value when m_isBorrowed */
+            const ajn::MsgArg *m_value;
+            bool m_isBorrowed;
+            Value(ajn::BusAttachment &bus) : m_msg(bus), m_value(NULL), m_isBorrowed(false) { }
+            const ajn::MsgArg *GetValue() const { return m_isBorrowed ? m_value : &m_copy; }
+        };
+        ajn::BusAttachment *m_bus;
+        std::map<std::string, Value> m_values; /* Indexed by property name */
+        uint64_t m_tick;
+};
+
+#endif
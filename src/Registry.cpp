@@ -0,0 +1,167 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "Registry.h"
+
+#include "Presence.h"
+#include "VirtualBusAttachment.h"
+#include "VirtualDevice.h"
+#include "VirtualResource.h"
+
+Registry::Entry *Registry::Find(const std::string &id) const
+{
+    std::unordered_map<std::string, Entry *>::const_iterator it = m_entries.find(id);
+    return (it != m_entries.end()) ? it->second : NULL;
+}
+
+Registry::Entry *Registry::FindBySessionId(ajn::SessionId sessionId) const
+{
+    std::unordered_map<ajn::SessionId, std::string>::const_iterator it =
+            m_sessionIds.find(sessionId);
+    return (it != m_sessionIds.end()) ? Find(it->second) : NULL;
+}
+
+Registry::Entry *Registry::FindByPiid(const std::string &piid) const
+{
+    return FindIndexed(m_piids, piid);
+}
+
+Registry::Entry *Registry::FindByBusName(const std::string &uniqueName) const
+{
+    return FindIndexed(m_busNames, uniqueName);
+}
+
+Registry::Entry *Registry::FindIndexed(const std::unordered_map<std::string, std::string> &index,
+        const std::string &key) const
+{
+    std::unordered_map<std::string, std::string>::const_iterator it = index.find(key);
+    return (it != index.end()) ? Find(it->second) : NULL;
+}
+
+Registry::Entry *Registry::Get(const std::string &id)
+{
+    Entry *&entry = m_entries[id];
+    if (!entry)
+    {
+        entry = new Entry(id);
+    }
+    return entry;
+}
+
+void Registry::AddPresence(const std::string &id, Presence *presence)
+{
+    Entry *entry = Get(id);
+    delete entry->m_presence;
+    entry->m_presence = presence;
+}
+
+void Registry::AddDevice(const std::string &id, VirtualDevice *device)
+{
+    Entry *entry = Get(id);
+    if (entry->m_device)
+    {
+        m_sessionIds.erase(entry->m_device->GetSessionId());
+        delete entry->m_device;
+    }
+    entry->m_device = device;
+    m_sessionIds[device->GetSessionId()] = id;
+}
+
+void Registry::AddResource(const std::string &id, VirtualResource *resource)
+{
+    Entry *entry = Get(id);
+    VirtualResource *&r = entry->m_resources[resource->GetPath().c_str()];
+    delete r;
+    r = resource;
+}
+
+void Registry::AddBus(const std::string &id, VirtualBusAttachment *bus)
+{
+    Entry *entry = Get(id);
+    if (entry->m_bus)
+    {
+        m_piids.erase(entry->m_bus->GetProtocolIndependentId());
+        m_busNames.erase(entry->m_bus->GetUniqueName().c_str());
+        delete entry->m_bus;
+    }
+    entry->m_bus = bus;
+    m_piids[bus->GetProtocolIndependentId()] = id;
+    if (!bus->GetUniqueName().empty())
+    {
+        m_busNames[bus->GetUniqueName().c_str()] = id;
+    }
+}
+
+void Registry::RemoveResource(const std::string &id, const std::string &path)
+{
+    Entry *entry = Find(id);
+    if (!entry)
+    {
+        return;
+    }
+    std::map<std::string, VirtualResource *>::iterator it = entry->m_resources.find(path);
+    if (it != entry->m_resources.end())
+    {
+        delete it->second;
+        entry->m_resources.erase(it);
+    }
+}
+
+void Registry::Destroy(const std::string &id)
+{
+    std::unordered_map<std::string, Entry *>::iterator it = m_entries.find(id);
+    if (it == m_entries.end())
+    {
+        return;
+    }
+    Entry *entry = it->second;
+    m_entries.erase(it);
+    Delete(entry);
+}
+
+void Registry::Clear()
+{
+    for (auto &e : m_entries)
+    {
+        Delete(e.second);
+    }
+    m_entries.clear();
+}
+
+void Registry::Delete(Entry *entry)
+{
+    if (entry->m_bus)
+    {
+        m_piids.erase(entry->m_bus->GetProtocolIndependentId());
+        m_busNames.erase(entry->m_bus->GetUniqueName().c_str());
+        delete entry->m_bus;
+    }
+    for (auto &r : entry->m_resources)
+    {
+        delete r.second;
+    }
+    if (entry->m_device)
+    {
+        m_sessionIds.erase(entry->m_device->GetSessionId());
+        delete entry->m_device;
+    }
+    delete entry->m_presence;
+    delete entry;
+}
@@ -0,0 +1,96 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _REGISTRY_H
+#define _REGISTRY_H
+
+#include <alljoyn/Session.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Presence;
+class VirtualBusAttachment;
+class VirtualDevice;
+class VirtualResource;
+
+/*
+ * The objects created for each bridged device.  Entries are keyed by the id of the device, the
+ * AllJoyn unique name for AllJoyn devices and the di for OC devices, and are also indexed by
+ * piid, session id and the unique name of the virtual bus attachment so that an event for a
+ * device does not require scanning every object of every other device.
+ *
+ * The registry owns the objects added to it.  Not thread-safe, callers are expected to provide
+ * their own locking.
+ */
+class Registry
+{
+    public:
+        struct Entry
+        {
+            std::string m_id;
+            Presence *m_presence;
+            VirtualDevice *m_device;
+            std::map<std::string, VirtualResource *> m_resources; /* path => resource */
+            VirtualBusAttachment *m_bus;
+            Entry(const std::string &id)
+                : m_id(id), m_presence(NULL), m_device(NULL), m_bus(NULL) { }
+        };
+        typedef std::unordered_map<std::string, Entry *>::const_iterator Iterator;
+
+        Registry() { }
+        ~Registry() { Clear(); }
+
+        Entry *Find(const std::string &id) const;
+        Entry *FindBySessionId(ajn::SessionId sessionId) const;
+        Entry *FindByPiid(const std::string &piid) const;
+        Entry *FindByBusName(const std::string &uniqueName) const;
+
+        /* Each Add replaces and deletes any object of the same kind (and path) already added. */
+        void AddPresence(const std::string &id, Presence *presence);
+        void AddDevice(const std::string &id, VirtualDevice *device);
+        void AddResource(const std::string &id, VirtualResource *resource);
+        void AddBus(const std::string &id, VirtualBusAttachment *bus);
+        void RemoveResource(const std::string &id, const std::string &path);
+
+        /* Deletes everything that belongs to id. */
+        void Destroy(const std::string &id);
+        void Clear();
+
+        /* Unordered iteration over the entries. */
+        Iterator Begin() const { return m_entries.begin(); }
+        Iterator End() const { return m_entries.end(); }
+
+    private:
+        std::unordered_map<std::string, Entry *> m_entries;
+        std::unordered_map<ajn::SessionId, std::string> m_sessionIds; /* session id => id */
+        std::unordered_map<std::string, std::string> m_piids; /* piid => id */
+        std::unordered_map<std::string, std::string> m_busNames; /* bus unique name => id */
+
+        Registry(const Registry &);
+        Registry &operator=(const Registry &);
+        Entry *Get(const std::string &id);
+        Entry *FindIndexed(const std::unordered_map<std::string, std::string> &index,
+                const std::string &key) const;
+        void Delete(Entry *entry);
+};
+
+#endif
@@ -0,0 +1,156 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "TaskQueue.h"
+
+#include <assert.h>
+#include <chrono>
+
+const uint64_t TaskQueue::NEVER;
+const size_t TaskQueue::Task::NOT_SCHEDULED;
+
+uint64_t GetMonotonicMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TaskQueue::~TaskQueue()
+{
+    for (Task *task : m_heap)
+    {
+        task->m_index = Task::NOT_SCHEDULED;
+        delete task;
+    }
+}
+
+void TaskQueue::Schedule(Task *task, uint64_t tick)
+{
+    if (task->IsScheduled())
+    {
+        assert(m_heap[task->m_index] == task);
+        uint64_t prevTick = task->m_tick;
+        task->m_tick = tick;
+        if (tick < prevTick)
+        {
+            SiftUp(task->m_index);
+        }
+        else
+        {
+            SiftDown(task->m_index);
+        }
+    }
+    else
+    {
+        task->m_tick = tick;
+        m_heap.push_back(task);
+        task->m_index = m_heap.size() - 1;
+        SiftUp(task->m_index);
+    }
+}
+
+bool TaskQueue::Cancel(Task *task)
+{
+    if (!task->IsScheduled())
+    {
+        return false;
+    }
+    assert(m_heap[task->m_index] == task);
+    Remove(task->m_index);
+    return true;
+}
+
+TaskQueue::Task *TaskQueue::Pop(uint64_t now)
+{
+    if (m_heap.empty() || (m_heap[0]->m_tick > now))
+    {
+        return NULL;
+    }
+    Task *task = m_heap[0];
+    Remove(0);
+    return task;
+}
+
+void TaskQueue::Set(size_t i, Task *task)
+{
+    m_heap[i] = task;
+    task->m_index = i;
+}
+
+void TaskQueue::SiftUp(size_t i)
+{
+    Task *task = m_heap[i];
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (m_heap[parent]->m_tick <= task->m_tick)
+        {
+            break;
+        }
+        Set(i, m_heap[parent]);
+        i = parent;
+    }
+    Set(i, task);
+}
+
+void TaskQueue::SiftDown(size_t i)
+{
+    Task *task = m_heap[i];
+    size_t n = m_heap.size();
+    for (;;)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= n)
+        {
+            break;
+        }
+        if ((child + 1 < n) && (m_heap[child + 1]->m_tick < m_heap[child]->m_tick))
+        {
+            ++child;
+        }
+        if (task->m_tick <= m_heap[child]->m_tick)
+        {
+            break;
+        }
+        Set(i, m_heap[child]);
+        i = child;
+    }
+    Set(i, task);
+}
+
+void TaskQueue::Remove(size_t i)
+{
+    Task *task = m_heap[i];
+    Task *last = m_heap.back();
+    m_heap.pop_back();
+    task->m_index = Task::NOT_SCHEDULED;
+    if (task != last)
+    {
+        Set(i, last);
+        if ((i > 0) && (last->m_tick < m_heap[(i - 1) / 2]->m_tick))
+        {
+            SiftUp(i);
+        }
+        else
+        {
+            SiftDown(i);
+        }
+    }
+}
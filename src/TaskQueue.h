@@ -0,0 +1,83 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _TASKQUEUE_H
+#define _TASKQUEUE_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <vector>
+
+/* Milliseconds from an arbitrary, monotonically increasing epoch. */
+uint64_t GetMonotonicMs();
+
+/*
+ * A min-heap of tasks ordered by tick.  Tasks are intrusive: each task remembers its position
+ * in the heap so that rescheduling and cancelling an already scheduled task are O(log n).
+ *
+ * Not thread-safe, callers are expected to provide their own locking.
+ */
+class TaskQueue
+{
+    public:
+        class Task
+        {
+            public:
+                Task() : m_tick(0), m_index(NOT_SCHEDULED) { }
+                virtual ~Task() { }
+                uint64_t GetTick() const { return m_tick; }
+                bool IsScheduled() const { return m_index != NOT_SCHEDULED; }
+            private:
+                friend class TaskQueue;
+                static const size_t NOT_SCHEDULED = (size_t) -1;
+                uint64_t m_tick;
+                size_t m_index;
+        };
+        static const uint64_t NEVER = UINT64_MAX;
+
+        TaskQueue() { }
+        ~TaskQueue();
+
+        /* Schedules task to be due at tick, moving it if it is already scheduled. */
+        void Schedule(Task *task, uint64_t tick);
+        /* Removes task from the queue, the caller retains ownership of task. */
+        bool Cancel(Task *task);
+        /* Removes and returns the earliest task due at or before now, or NULL if none are due. */
+        Task *Pop(uint64_t now);
+        /* Returns the tick of the earliest task or NEVER if the queue is empty. */
+        uint64_t GetNextTick() const { return m_heap.empty() ? NEVER : m_heap[0]->m_tick; }
+        size_t Size() const { return m_heap.size(); }
+        bool Empty() const { return m_heap.empty(); }
+        /* Unordered iteration over the scheduled tasks. */
+        std::vector<Task *>::const_iterator Begin() const { return m_heap.begin(); }
+        std::vector<Task *>::const_iterator End() const { return m_heap.end(); }
+
+    private:
+        std::vector<Task *> m_heap;
+
+        TaskQueue(const TaskQueue &);
+        TaskQueue &operator=(const TaskQueue &);
+        void Set(size_t i, Task *task);
+        void SiftUp(size_t i);
+        void SiftDown(size_t i);
+        void Remove(size_t i);
+};
+
+#endif
@@ -0,0 +1,72 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "TranslatedValues.h"
+
+#include "ocpayload.h"
+#include <assert.h>
+
+TranslatedValues::~TranslatedValues()
+{
+    for (size_t i = 0; i < m_values.size(); ++i)
+    {
+        OCRepPayloadDestroy(m_values[i].m_holder);
+    }
+}
+
+void TranslatedValues::Set(size_t i, OCRepPayload *holder)
+{
+    assert(!m_values[i].m_isSet);
+    m_values[i].m_holder = holder;
+    m_values[i].m_isSet = true;
+}
+
+bool TranslatedValues::AddTo(OCRepPayload *payload, size_t i)
+{
+    Value &value = m_values[i];
+    assert(value.m_isSet && value.m_numUses);
+    if (!value.m_holder)
+    {
+        return false;
+    }
+    OCRepPayload *from;
+    if (--value.m_numUses == 0)
+    {
+        from = value.m_holder;
+        value.m_holder = NULL;
+    }
+    else
+    {
+        from = OCRepPayloadClone(value.m_holder);
+        if (!from)
+        {
+            return false;
+        }
+    }
+    OCRepPayloadValue **tail = &payload->values;
+    while (*tail)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = from->values;
+    from->values = NULL;
+    OCRepPayloadDestroy(from);
+    return true;
+}
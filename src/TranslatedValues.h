@@ -0,0 +1,66 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _TRANSLATEDVALUES_H
+#define _TRANSLATEDVALUES_H
+
+#include "octypes.h"
+#include <vector>
+
+/*
+ * The translations of the values of a PropertiesChanged signal shared by the payloads of the
+ * observer groups notified of them, so that each value is translated once however many groups
+ * select it.  The stack owns a payload once it is notified, so a payload gets a copy of each
+ * value except the last payload using it, which gets the translation itself.
+ *
+ * Not thread-safe, callers are expected to provide their own locking.
+ */
+class TranslatedValues
+{
+    public:
+        TranslatedValues(size_t numValues) : m_values(numValues) { }
+        ~TranslatedValues();
+
+        /* Counts a payload that value i will be added to. */
+        void Use(size_t i) { ++m_values[i].m_numUses; }
+        bool IsSet(size_t i) const { return m_values[i].m_isSet; }
+        /*
+         * Takes ownership of holder, whose only value is the translation of value i, or NULL when
+         * value i cannot be translated.
+         */
+        void Set(size_t i, OCRepPayload *holder);
+        /* Returns false when value i cannot be translated. */
+        bool AddTo(OCRepPayload *payload, size_t i);
+
+    private:
+        struct Value
+        {
+            OCRepPayload *m_holder;
+            size_t m_numUses; /* Payloads value is not yet added to */
+            bool m_isSet;
+            Value() : m_holder(NULL), m_numUses(0), m_isSet(false) { }
+        };
+        std::vector<Value> m_values;
+
+        TranslatedValues(const TranslatedValues &);
+        TranslatedValues &operator=(const TranslatedValues &);
+};
+
+#endif
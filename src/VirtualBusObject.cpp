@@ -53,10 +53,14 @@ struct VirtualBusObject::DoResourceContext
 {
     public:
         DoResourceContext(VirtualBusObject *obj, VirtualBusObject::DoResourceHandler cb, ajn::Message &msg)
-            : m_obj(obj), m_cb(cb), m_msg(msg), m_handle(NULL) { }
+            : m_obj(obj), m_handle(NULL)
+        {
+            m_replies.push_back(std::make_pair(cb, msg));
+        }
         VirtualBusObject *m_obj;
-        VirtualBusObject::DoResourceHandler m_cb;
-        ajn::Message m_msg;
+        /* The requests replied to with the response, more than one when a GET is shared */
+        std::vector<std::pair<VirtualBusObject::DoResourceHandler, ajn::Message>> m_replies;
+        std::string m_uri; /* When in m_gets */
         OCDoHandle m_handle;
 };
 
@@ -188,13 +192,10 @@ OCStackApplicationResult VirtualBusObject::ObserveCB(void *ctx, OCDoHandle handl
     std::lock_guard<std::mutex> lock(context->m_obj->m_mutex);
     if (response && response->result == OC_STACK_OK && response->payload)
     {
-        OCRepPayloadValue value;
-        memset(&value, 0, sizeof(value));
-        value.type = OCREP_PROP_OBJECT;
-        value.obj = (OCRepPayload *) response->payload;
         ajn::MsgArg args[3];
         args[0].Set("s", context->m_iface.c_str());
-        ToAJMsgArg(&args[1], "a{sv}", &value);
+        context->m_obj->ToAJProperties(&args[1], context->m_iface.c_str(),
+                                       (OCRepPayload *) response->payload);
         args[2].Set("as", 0, NULL);
         const ajn::InterfaceDescription *iface = context->m_obj->m_bus->GetInterface(
                     ajn::org::freedesktop::DBus::Properties::InterfaceName);
@@ -231,12 +232,13 @@ void VirtualBusObject::GetPropCB(ajn::Message &msg, OCRepPayload *payload)
 {
     LOG(LOG_INFO, "[%p]", this);
 
+    const ajn::InterfaceDescription *iface = m_bus->GetInterface(msg->GetArg(0)->v_string.str);
     ajn::MsgArg arg;
     for (OCRepPayloadValue *value = payload->values; value; value = value->next)
     {
         if (!strcmp(value->name, msg->GetArg(1)->v_string.str))
         {
-            ToAJMsgArg(&arg, "v", value);
+            ToAJProperty(&arg, iface, value);
             break;
         }
     }
@@ -293,12 +295,8 @@ void VirtualBusObject::GetAllPropsCB(ajn::Message &msg, OCRepPayload *payload)
 {
     LOG(LOG_INFO, "[%p]", this);
 
-    OCRepPayloadValue value;
-    memset(&value, 0, sizeof(value));
-    value.type = OCREP_PROP_OBJECT;
-    value.obj = payload;
     ajn::MsgArg arg;
-    ToAJMsgArg(&arg, "a{sv}", &value);
+    ToAJProperties(&arg, msg->GetArg(0)->v_string.str, payload);
     QStatus status = MethodReply(msg, &arg, 1);
     if (status != ER_OK)
     {
@@ -306,12 +304,111 @@ void VirtualBusObject::GetAllPropsCB(ajn::Message &msg, OCRepPayload *payload)
     }
 }
 
-/* This must be called with m_mutex held. */
+/* Called with m_mutex held. */
+const TranslationPlan *VirtualBusObject::GetPlan(
+        const ajn::InterfaceDescription::Property *property)
+{
+    std::map<const ajn::InterfaceDescription::Property *, TranslationPlan>::iterator it =
+            m_plans.find(property);
+    if (it == m_plans.end())
+    {
+        it = m_plans.insert(std::make_pair(property, TranslationPlan())).first;
+        if (!it->second.Compile(property->signature.c_str(), std::shared_ptr<const Types>()))
+        {
+            LOG(LOG_INFO, "[%p] No plan for %s %s", this, property->name.c_str(),
+                    property->signature.c_str());
+        }
+    }
+    return it->second.m_ops.empty() ? NULL : &it->second;
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * The value is translated to the declared type of the property of the same name in iface,
+ * falling back to the type of the value itself when there is no such property or the value
+ * does not fit the declared type.
+ */
+bool VirtualBusObject::ToAJProperty(ajn::MsgArg *arg, const ajn::InterfaceDescription *iface,
+        OCRepPayloadValue *value)
+{
+    const ajn::InterfaceDescription::Property *property = iface ? iface->GetProperty(value->name) :
+            NULL;
+    const TranslationPlan *plan = property ? GetPlan(property) : NULL;
+    if (plan)
+    {
+        ajn::MsgArg *val = new ajn::MsgArg();
+        if (ToAJMsgArg(val, *plan, value))
+        {
+            arg->typeId = ajn::ALLJOYN_VARIANT;
+            arg->v_variant.val = val;
+            arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
+            return true;
+        }
+        delete val;
+    }
+    return ToAJMsgArg(arg, "v", value);
+}
+
+/* Called with m_mutex held. */
+bool VirtualBusObject::ToAJProperties(ajn::MsgArg *arg, const char *ifaceName,
+        OCRepPayload *payload)
+{
+    const ajn::InterfaceDescription *iface = m_bus->GetInterface(ifaceName);
+    size_t numEntries = 0;
+    for (OCRepPayloadValue *value = payload->values; value; value = value->next)
+    {
+        ++numEntries;
+    }
+    ajn::MsgArg *entries = new ajn::MsgArg[numEntries];
+    ajn::MsgArg *entry = entries;
+    bool success = true;
+    for (OCRepPayloadValue *value = payload->values; success && value; value = value->next)
+    {
+        entry->typeId = ajn::ALLJOYN_DICT_ENTRY;
+        entry->v_dictEntry.key = new ajn::MsgArg("s", value->name);
+        entry->v_dictEntry.val = new ajn::MsgArg();
+        entry->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
+        success = ToAJProperty(entry->v_dictEntry.val, iface, value);
+        ++entry;
+    }
+    if (success)
+    {
+        arg->typeId = ajn::ALLJOYN_ARRAY;
+        success = (arg->v_array.SetElements("{sv}", numEntries, entries) == ER_OK);
+    }
+    if (success)
+    {
+        arg->SetOwnershipFlags(ajn::MsgArg::OwnsArgs, false);
+    }
+    else
+    {
+        delete[] entries;
+    }
+    return success;
+}
+
+/*
+ * This must be called with m_mutex held.
+ *
+ * A GET of a uri already being fetched is not sent again, msg is replied to with the response
+ * to the GET in flight.
+ */
 void VirtualBusObject::DoResource(OCMethod method, const char *uri, OCRepPayload *payload,
                                   ajn::Message &msg, DoResourceHandler cb)
 {
     LOG(LOG_INFO, "[%p] method=%d,uri=%s,payload=%p", this, method, uri, payload);
 
+    if (method == OC_REST_GET)
+    {
+        std::map<std::string, DoResourceContext *>::iterator it = m_gets.find(uri);
+        if (it != m_gets.end())
+        {
+            LOG(LOG_INFO, "[%p] Sharing GET context=%p", this, it->second);
+            it->second->m_replies.push_back(std::make_pair(cb, msg));
+            return;
+        }
+    }
     DoResourceContext *context = new DoResourceContext(this, cb, msg);
     OCCallbackData cbData;
     cbData.cb = VirtualBusObject::DoResourceCB;
@@ -322,6 +419,11 @@ void VirtualBusObject::DoResource(OCMethod method, const char *uri, OCRepPayload
     if (result == OC_STACK_OK)
     {
         ++m_pending;
+        if (method == OC_REST_GET)
+        {
+            context->m_uri = uri;
+            m_gets[context->m_uri] = context;
+        }
     }
     else
     {
@@ -343,21 +445,25 @@ OCStackApplicationResult VirtualBusObject::DoResourceCB(void *ctx, OCDoHandle ha
             handle, response, response ? response->payload : 0, response ? response->result : 0);
 
     std::lock_guard<std::mutex> lock(context->m_obj->m_mutex);
+    VirtualBusObject *obj = context->m_obj;
+    if (!context->m_uri.empty())
+    {
+        obj->m_gets.erase(context->m_uri);
+    }
     if (response && (response->result > OC_STACK_RESOURCE_CHANGED))
     {
-        QStatus status;
-        const char *description;
+        std::string name;
+        const char *description = NULL;
         OCDiagnosticPayload *payload = (OCDiagnosticPayload *) response->payload;
         if (payload && (response->payload->type == PAYLOAD_TYPE_DIAGNOSTIC) &&
                 IsValidErrorName(payload->message, &description) && (*description == ':'))
         {
-            std::string name(payload->message, description - payload->message);
+            name.assign(payload->message, description - payload->message);
             ++description;
             while (isblank(*description))
             {
                 ++description;
             }
-            status = context->m_obj->MethodReply(context->m_msg, name.c_str(), description);
         }
         else
         {
@@ -396,32 +502,46 @@ OCStackApplicationResult VirtualBusObject::DoResourceCB(void *ctx, OCDoHandle ha
             }
             if (code)
             {
-                std::string name("org.openconnectivity.Error.");
-                name = name + std::to_string(code);
-                status = context->m_obj->MethodReply(context->m_msg, name.c_str());
+                name = std::string("org.openconnectivity.Error.") + std::to_string(code);
+            }
+            description = NULL;
+        }
+        for (size_t i = 0; i < context->m_replies.size(); ++i)
+        {
+            ajn::Message &msg = context->m_replies[i].second;
+            QStatus status;
+            if (!name.empty())
+            {
+                status = obj->MethodReply(msg, name.c_str(), description);
             }
             else
             {
-                status = context->m_obj->MethodReply(context->m_msg, ER_FAIL);
+                status = obj->MethodReply(msg, ER_FAIL);
+            }
+            if (status != ER_OK)
+            {
+                LOG(LOG_ERR, "MethodReply - %s", QCC_StatusText(status));
             }
-        }
-        if (status != ER_OK)
-        {
-            LOG(LOG_ERR, "MethodReply - %s", QCC_StatusText(status));
         }
     }
     else if (!response || !response->payload)
     {
-        QStatus status = context->m_obj->MethodReply(context->m_msg, ER_FAIL);
-        if (status != ER_OK)
+        for (size_t i = 0; i < context->m_replies.size(); ++i)
         {
-            LOG(LOG_ERR, "MethodReply - %s", QCC_StatusText(status));
+            QStatus status = obj->MethodReply(context->m_replies[i].second, ER_FAIL);
+            if (status != ER_OK)
+            {
+                LOG(LOG_ERR, "MethodReply - %s", QCC_StatusText(status));
+            }
         }
     }
     else
     {
         OCRepPayload *payload = (OCRepPayload *) response->payload;
-        (context->m_obj->*(context->m_cb))(context->m_msg, payload);
+        for (size_t i = 0; i < context->m_replies.size(); ++i)
+        {
+            (obj->*(context->m_replies[i].first))(context->m_replies[i].second, payload);
+        }
     }
     --context->m_obj->m_pending;
     context->m_obj->m_cond.notify_one();
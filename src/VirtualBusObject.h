@@ -21,10 +21,12 @@
 #ifndef _VIRTUALBUSOBJECT_H
 #define _VIRTUALBUSOBJECT_H
 
+#include "Payload.h"
 #include <inttypes.h>
 #include <alljoyn/BusObject.h>
 #include "octypes.h"
 #include <condition_variable>
+#include <map>
 #include <mutex>
 #include <set>
 #include <vector>
@@ -58,6 +60,13 @@ class VirtualBusObject : public ajn::BusObject
         std::vector<const ajn::InterfaceDescription *> m_ifaces;
         std::set<ObserveContext *> m_observes;
         size_t m_pending;
+        std::map<const ajn::InterfaceDescription::Property *, TranslationPlan> m_plans;
+        std::map<std::string, DoResourceContext *> m_gets; /* GETs in flight, indexed by URI */
+
+        const TranslationPlan *GetPlan(const ajn::InterfaceDescription::Property *property);
+        bool ToAJProperty(ajn::MsgArg *arg, const ajn::InterfaceDescription *iface,
+                OCRepPayloadValue *value);
+        bool ToAJProperties(ajn::MsgArg *arg, const char *ifaceName, OCRepPayload *payload);
 
         virtual void GetProp(const ajn::InterfaceDescription::Member *member, ajn::Message &msg);
         virtual void SetProp(const ajn::InterfaceDescription::Member *member, ajn::Message &msg);
@@ -22,12 +22,15 @@
 
 #include "Bridge.h"
 #include "Introspection.h"
+#include "IntrospectionCache.h"
 #include "Name.h"
 #include "Payload.h"
 #include "Plugin.h"
 #include <alljoyn/AllJoynStd.h>
 #include <alljoyn/BusAttachment.h>
 #include "Signature.h"
+#include "TaskQueue.h"
+#include "TranslatedValues.h"
 #include "ocpayload.h"
 #include "ocstack.h"
 #include "oic_malloc.h"
@@ -35,10 +38,17 @@
 #include <assert.h>
 
 VirtualResource *VirtualResource::Create(Bridge *bridge, ajn::BusAttachment *bus,
-        const char *name, ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion)
+        const char *name, ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion,
+        IntrospectionCache *cache, const char *piid, const char *softwareVersion)
 {
     VirtualResource *resource = new VirtualResource(bridge, bus, name, sessionId, path,
             ajSoftwareVersion);
+    if (cache)
+    {
+        resource->m_cache = cache;
+        resource->m_cacheId = std::string(piid) + path;
+        resource->m_cacheVersion = softwareVersion;
+    }
     OCStackResult result = resource->Create();
     if (result != OC_STACK_OK)
     {
@@ -54,6 +64,10 @@ VirtualResource::VirtualResource(Bridge *bridge, ajn::BusAttachment *bus, const
     , m_bridge(bridge)
     , m_bus(bus)
     , m_ajSoftwareVersion(ajSoftwareVersion)
+    , m_cache(NULL)
+    , m_fromCache(false)
+    , m_propertyMaxAgeMs(0)
+    , m_getAllBaseline(NULL)
 {
     LOG(LOG_INFO, "[%p] bus=%p,name=%s,sessionId=%d,path=%s,ajSoftwareVersion=%s",
         this, bus, name, sessionId, path, ajSoftwareVersion);
@@ -67,6 +81,18 @@ VirtualResource::~VirtualResource()
     DestroyResource(GetPath().c_str());
 }
 
+void VirtualResource::SetPropertyMaxAge(uint32_t maxAgeMs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_propertyMaxAgeMs = maxAgeMs;
+}
+
+void VirtualResource::SetNotifyCoalescing(uint32_t windowMs, uint32_t maxLatencyMs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingChanges.SetWindow(windowMs, maxLatencyMs);
+}
+
 OCStackResult VirtualResource::Create()
 {
     std::lock_guard<std::mutex> lock(m_mutex);
@@ -75,6 +101,18 @@ OCStackResult VirtualResource::Create()
                 ::ajn::org::allseen::Introspectable::InterfaceName);
     assert(iface);
     AddInterface(*iface);
+    std::string xml;
+    if (m_cache && m_cache->Get(m_cacheId, m_cacheVersion, xml))
+    {
+        QStatus status = ParseXml(xml.c_str());
+        if (status == ER_OK)
+        {
+            LOG(LOG_INFO, "[%p] Using cached introspection data", this);
+            m_fromCache = true;
+            return CreateResources();
+        }
+        LOG(LOG_ERR, "ParseXml - %s", QCC_StatusText(status));
+    }
     const ajn::InterfaceDescription::Member *member = iface->GetMember("IntrospectWithDescription");
     assert(member);
     ajn::MsgArg arg("s", "");
@@ -102,12 +140,17 @@ void VirtualResource::IntrospectCB(ajn::Message &msg, void *ctx)
         {
             case ajn::MESSAGE_METHOD_RET:
                 {
-                    QStatus status = ParseXml(msg->GetArg(0)->v_string.str);
+                    const char *xml = msg->GetArg(0)->v_string.str;
+                    QStatus status = ParseXml(xml);
                     if (status != ER_OK)
                     {
                         LOG(LOG_ERR, "ParseXml - %s", QCC_StatusText(status));
                         return;
                     }
+                    if (m_cache)
+                    {
+                        m_cache->Put(m_cacheId, m_cacheVersion, xml);
+                    }
                     break;
                 }
             case ajn::MESSAGE_ERROR:
@@ -138,6 +181,7 @@ OCStackResult VirtualResource::CreateResources()
         resourceProps |= OC_SECURE;
     }
     uint8_t access = NONE;
+    Types::Structs structs;
     size_t numIfaces = GetInterfaces(NULL, 0);
     const ajn::InterfaceDescription **ifaces = new const ajn::InterfaceDescription*[numIfaces];
     GetInterfaces(ifaces, numIfaces);
@@ -157,7 +201,8 @@ OCStackResult VirtualResource::CreateResources()
         {
             qcc::String value = (props[j]->name == "Version") ? "const" : "false";
             props[j]->GetAnnotation(::ajn::org::freedesktop::DBus::AnnotateEmitsChanged, value);
-            std::string rt = GetResourceTypeName(ifaces[i], value);
+            const std::string &rt = m_names.AddResourceType(ifaces[i], value.c_str())->m_rt;
+            m_names.AddProperty(ifaces[i], props[j]);
             switch (props[j]->access)
             {
                 case ajn::PROP_ACCESS_RW:
@@ -177,7 +222,8 @@ OCStackResult VirtualResource::CreateResources()
         ifaces[i]->GetMembers(members, numMembers);
         for (size_t j = 0; j < numMembers; ++j)
         {
-            std::string rt = GetResourceTypeName(ifaces[i], members[j]->name);
+            const std::string &rt = m_names.AddResourceType(ifaces[i],
+                    members[j]->name.c_str())->m_rt;
             if (members[j]->memberType == ajn::MESSAGE_METHOD_CALL)
             {
                 m_rts[rt] |= READWRITE;
@@ -215,14 +261,15 @@ OCStackResult VirtualResource::CreateResources()
                     continue;
                 }
                 qcc::String fieldName = names[j].substr(pos, dot - pos);
-                Types::m_structs[structName].push_back(Types::Field(fieldName, values[j]));
+                structs[structName.c_str()].push_back(Types::Field(fieldName.c_str(),
+                        values[j].c_str()));
             }
         }
         delete[] names;
         delete[] values;
         if (!numProps && !numMembers)
         {
-            std::string rt = GetResourceTypeName(ifaceName);
+            const std::string &rt = m_names.AddResourceType(ifaces[i], NULL)->m_rt;
             m_rts[rt] |= READ;
         }
         ajn::InterfaceSecurityPolicy secPolicy = ifaces[i]->GetSecurityPolicy();
@@ -232,12 +279,22 @@ OCStackResult VirtualResource::CreateResources()
             resourceProps |= OC_SECURE;
         }
     }
+    m_types.reset(new Types(structs));
+    for (size_t i = 0; i < numIfaces; ++i)
+    {
+        if (TranslateInterface(ifaces[i]->GetName()))
+        {
+            CompilePlans(ifaces[i]);
+        }
+    }
     delete[] ifaces;
     if (m_rts.empty())
     {
         LOG(LOG_INFO, "No translatable interfaces");
         return OC_STACK_NO_RESOURCE;
     }
+    CreateRoutes();
+    m_defaultRoutes = m_routes.find(m_rts.begin()->first);
 
     const ajn::InterfaceDescription *iface = m_bus->GetInterface(
         ::ajn::org::freedesktop::DBus::Properties::InterfaceName);
@@ -272,143 +329,239 @@ OCStackResult VirtualResource::CreateResources()
     return result;
 }
 
-static std::map<std::string, std::string> ParseQuery(const char *query)
+/* Returns the index of the interface in a query, IF_NONE when it has none */
+static size_t GetInterfaceIndex(const char *itf, size_t len)
 {
-    std::map<std::string, std::string> queryMap;
-    if (query)
+    static const char *interfaces[] =
+    {
+        OC_RSRVD_INTERFACE_DEFAULT, OC_RSRVD_INTERFACE_READ_WRITE, OC_RSRVD_INTERFACE_READ
+    };
+    for (size_t i = 0; i < sizeof(interfaces) / sizeof(interfaces[0]); ++i)
     {
-        std::string queryStr = query;
-        std::string::size_type beg, end = 0;
-        beg = 0;
-        while (end != std::string::npos)
+        if ((strlen(interfaces[i]) == len) && !strncmp(interfaces[i], itf, len))
         {
-            std::string key, value;
-            end = queryStr.find('=', beg);
-            if (end == std::string::npos)
-            {
-                key = queryStr.substr(beg);
-            }
-            else
-            {
-                key = queryStr.substr(beg, end - beg);
-                beg = end + 1;
-                end = queryStr.find_first_of("&;", beg);
-                if (end == std::string::npos)
-                {
-                    value = queryStr.substr(beg);
-                }
-                else
-                {
-                    value = queryStr.substr(beg, end - beg);
-                    beg = end + 1;
-                }
-            }
-            queryMap[key] = value;
+            return VirtualResource::IF_BASELINE + i;
         }
     }
-    return queryMap;
+    return VirtualResource::NUM_INTERFACES; /* Unsupported */
 }
 
-static std::string GetResourceType(std::map<std::string, std::string> &query,
-                                   std::string defaultResourceType)
+/*
+ * Only the rt and if of a query are used to route a request.  As before, the last of repeated
+ * keys wins.
+ */
+static void ParseQuery(const char *query, std::string &rt, size_t &itf)
 {
-    std::string rt = defaultResourceType;
-    if (query.find(OC_RSRVD_RESOURCE_TYPE) != query.end())
+    itf = VirtualResource::IF_NONE;
+    if (!query)
     {
-        rt = query[OC_RSRVD_RESOURCE_TYPE];
+        return;
     }
-    return rt;
-}
-
-static uint8_t GetAccess(std::map<std::string, std::string> &query,
-                         uint8_t accessFlags)
-{
-    uint8_t access = NONE;
-    if (query.find(OC_RSRVD_INTERFACE) != query.end())
+    const size_t rtLen = sizeof(OC_RSRVD_RESOURCE_TYPE) - 1;
+    const size_t ifLen = sizeof(OC_RSRVD_INTERFACE) - 1;
+    while (*query)
     {
-        if (query[OC_RSRVD_INTERFACE] == OC_RSRVD_INTERFACE_DEFAULT)
+        const char *key = query;
+        const char *value = NULL;
+        while (*query && (*query != '&') && (*query != ';'))
         {
-            access = READWRITE;
-        }
-        else if (query[OC_RSRVD_INTERFACE] == OC_RSRVD_INTERFACE_READ_WRITE)
-        {
-            access = READWRITE;
+            if ((*query == '=') && !value)
+            {
+                value = query + 1;
+            }
+            ++query;
         }
-        else if (query[OC_RSRVD_INTERFACE] == OC_RSRVD_INTERFACE_READ)
+        if (value)
         {
-            access = READ;
+            size_t keyLen = value - 1 - key;
+            size_t valueLen = query - value;
+            if ((keyLen == rtLen) && !strncmp(key, OC_RSRVD_RESOURCE_TYPE, rtLen))
+            {
+                rt.assign(value, valueLen);
+            }
+            else if ((keyLen == ifLen) && !strncmp(key, OC_RSRVD_INTERFACE, ifLen))
+            {
+                itf = GetInterfaceIndex(value, valueLen);
+            }
         }
-    }
-    else
-    {
-        if (accessFlags & READ)
+        else if ((query - key == (ptrdiff_t) ifLen) && !strncmp(key, OC_RSRVD_INTERFACE, ifLen))
         {
-            access = READ;
+            itf = VirtualResource::NUM_INTERFACES;
         }
-        else if (accessFlags & READWRITE)
+        if (*query)
         {
-            access = READWRITE;
+            ++query;
         }
     }
-    return access;
 }
 
-/* Filter properties based on resource type and interface requested. */
-static bool ToFilteredOCPayload(OCRepPayload *payload,
-                                const std::string ajSoftwareVersion,
-                                const ajn::InterfaceDescription *iface,
-                                const char *emitsChangedValue, uint8_t access,
-                                const ajn::MsgArg *dict)
+static uint8_t GetAccess(size_t itf, uint8_t accessFlags)
 {
-    bool success = true;
-    size_t numEntries = dict->v_array.GetNumElements();
-    for (size_t i = 0; success && i < numEntries; ++i)
+    uint8_t access = NONE;
+    switch (itf)
     {
-        const ajn::MsgArg *entry = &dict->v_array.GetElements()[i];
-        const char *key = entry->v_dictEntry.key->v_string.str;
-        const ajn::InterfaceDescription::Property *property = iface->GetProperty(key);
-        if (property)
-        {
-            if ((access == READWRITE) &&
-                (property->access == ajn::PROP_ACCESS_READ))
+        case VirtualResource::IF_NONE:
+            if (accessFlags & READ)
             {
-                continue;
+                access = READ;
             }
-            qcc::String emitsChanged = (property->name == "Version") ? "const" : "false";
-            property->GetAnnotation(::ajn::org::freedesktop::DBus::AnnotateEmitsChanged, emitsChanged);
-            if (strcmp(emitsChangedValue, emitsChanged.c_str()))
+            else if (accessFlags & READWRITE)
             {
-                continue;
+                access = READWRITE;
             }
-            /*
-             * Annotations prior to v16.10.00 are not guaranteed to
-             * appear in the order they were specified, so are
-             * unreliable.
-             */
-            qcc::String signature = property->signature;
-            if (ajSoftwareVersion >= "v16.10.00")
+            break;
+        case VirtualResource::IF_BASELINE:
+        case VirtualResource::IF_READ_WRITE:
+            access = READWRITE;
+            break;
+        case VirtualResource::IF_READ:
+            access = READ;
+            break;
+    }
+    return access;
+}
+
+/* Called with m_mutex held. */
+void VirtualResource::CreateRoutes()
+{
+    for (std::map<std::string, uint8_t>::iterator it = m_rts.begin(); it != m_rts.end(); ++it)
+    {
+        const Names::ResourceType *rt = m_names.GetResourceType(it->first.c_str());
+        assert(rt);
+        const char *memberName = rt->m_memberName.c_str();
+        Route route;
+        route.m_rt = rt;
+        route.m_isProperties = !strcmp(memberName, "const") || !strcmp(memberName, "true") ||
+                !strcmp(memberName, "false") || !strcmp(memberName, "invalidates");
+        route.m_callFlags = GetMethodCallFlags(rt->m_iface->GetName());
+        route.m_member = route.m_isProperties ? NULL : rt->m_iface->GetMember(memberName);
+        route.m_plan = route.m_member ? GetPlan(route.m_member) : NULL;
+        Routes &routes = m_routes[it->first];
+        for (size_t i = 0; i < NUM_INTERFACES; ++i)
+        {
+            route.m_access = GetAccess(i, it->second);
+            route.m_filter.clear();
+            if (route.m_isProperties && route.m_access)
             {
-                property->GetAnnotation("org.alljoyn.Bus.Type.Name", signature);
+                CreateFilter(route.m_filter, rt->m_iface, memberName, route.m_access);
             }
-            qcc::String propName = GetPropName(iface, key);
-            success = ToOCPayload(payload, propName.c_str(), entry->v_dictEntry.val->v_variant.val,
-                                  signature.c_str());
+            routes.m_route[i] = route;
         }
     }
-    return success;
 }
 
-struct MethodCallContext
+/*
+ * Called with m_mutex held.
+ *
+ * A property with a NULL plan fails the translation of any payload it is in.
+ */
+void VirtualResource::CreateFilter(PropertyFilter &filter, const ajn::InterfaceDescription *iface,
+        const char *emitsChangedValue, uint8_t access)
+{
+    size_t numProps = iface->GetProperties(NULL, 0);
+    const ajn::InterfaceDescription::Property **props = new const
+            ajn::InterfaceDescription::Property*[numProps];
+    iface->GetProperties(props, numProps);
+    for (size_t i = 0; i < numProps; ++i)
+    {
+        if ((access == READWRITE) &&
+            (props[i]->access == ajn::PROP_ACCESS_READ))
+        {
+            continue;
+        }
+        const PropertyPlan *plan = GetPlan(iface, props[i]);
+        if (!plan || (plan->m_emitsChanged == emitsChangedValue))
+        {
+            filter[props[i]] = plan;
+        }
+    }
+    delete[] props;
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * Returns NULL when the resource type or interface of the query is not supported.
+ */
+const VirtualResource::Route *VirtualResource::GetRoute(const char *query, size_t *itf)
+{
+    std::string rt;
+    size_t i;
+    ParseQuery(query, rt, i);
+    if (itf)
+    {
+        *itf = i;
+    }
+    if (i >= NUM_INTERFACES)
+    {
+        return NULL;
+    }
+    std::unordered_map<std::string, Routes>::iterator it = rt.empty() ? m_defaultRoutes :
+            m_routes.find(rt);
+    if ((it == m_routes.end()) || !it->second.m_route[i].m_access)
+    {
+        return NULL;
+    }
+    return &it->second.m_route[i];
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * Returns false when id is already registered.
+ */
+bool VirtualResource::AddObserver(const Route *route, OCObservationId id)
+{
+    if (m_observerIds.find(id) != m_observerIds.end())
+    {
+        return false;
+    }
+    std::vector<OCObservationId> &ids = m_observers[route];
+    Observer &observer = m_observerIds[id];
+    observer.m_route = route;
+    observer.m_index = ids.size();
+    ids.push_back(id);
+    return true;
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * Returns false when id is not registered.
+ */
+bool VirtualResource::RemoveObserver(OCObservationId id)
+{
+    std::unordered_map<OCObservationId, Observer>::iterator it = m_observerIds.find(id);
+    if (it == m_observerIds.end())
+    {
+        return false;
+    }
+    Observers::iterator group = m_observers.find(it->second.m_route);
+    std::vector<OCObservationId> &ids = group->second;
+    /* Move the last id of the group into the place of the removed one */
+    OCObservationId last = ids.back();
+    ids[it->second.m_index] = last;
+    m_observerIds[last].m_index = it->second.m_index;
+    ids.pop_back();
+    m_observerIds.erase(it);
+    if (ids.empty())
+    {
+        m_observers.erase(group);
+    }
+    return true;
+}
+
+struct VirtualResource::MethodCallContext
 {
     std::string m_ajSoftwareVersion;
-    std::string m_rt;
-    uint8_t m_access;
+    const Route *m_route;
     const ajn::InterfaceDescription::Member *m_member;
     OCEntityHandlerResponse *m_response;
-    MethodCallContext(std::string ajSoftwareVersion, std::string &rt, uint8_t access,
+    std::vector<MethodCallContext *> m_waiters; /* GETs sharing the GetAll call */
+    MethodCallContext(std::string ajSoftwareVersion, const Route *route,
                       const ajn::InterfaceDescription::Member *member,
                       OCEntityHandlerRequest *request)
-        : m_ajSoftwareVersion(ajSoftwareVersion), m_rt(rt), m_access(access), m_member(member),
+        : m_ajSoftwareVersion(ajSoftwareVersion), m_route(route), m_member(member),
           m_response(NULL)
     {
         m_response = (OCEntityHandlerResponse *) calloc(1, sizeof(OCEntityHandlerResponse));
@@ -446,19 +599,27 @@ struct VirtualResource::SetContext
 };
 
 
+struct VirtualResource::GetAllInvalidatedContext
+{
+    std::string m_ifaceName;
+    GetAllInvalidatedContext(const char *ifaceName)
+        : m_ifaceName(ifaceName) { }
+};
+
 struct VirtualResource::GetAllBaselineContext
 {
     std::string m_ajSoftwareVersion;
     const ajn::InterfaceDescription **m_ifaces;
     size_t m_numIfaces;
-    size_t m_iface;
+    size_t m_numPending; /* GetAll calls not yet replied to */
     OCRepPayload *m_payload;
     OCEntityHandlerResponse *m_response;
+    std::vector<OCEntityHandlerResponse *> m_waiters; /* GETs sharing the response */
     GetAllBaselineContext(std::string ajSoftwareVersion, const ajn::InterfaceDescription **ifaces,
                           size_t numIfaces,
                           OCRepPayload *payload, OCEntityHandlerRequest *request)
-        : m_ajSoftwareVersion(ajSoftwareVersion), m_ifaces(ifaces), m_numIfaces(numIfaces), m_iface(0),
-          m_payload(payload), m_response(NULL)
+        : m_ajSoftwareVersion(ajSoftwareVersion), m_ifaces(ifaces), m_numIfaces(numIfaces),
+          m_numPending(0), m_payload(payload), m_response(NULL)
     {
         m_response = (OCEntityHandlerResponse *) calloc(1, sizeof(OCEntityHandlerResponse));
         m_response->requestHandle = request->requestHandle;
@@ -469,9 +630,21 @@ struct VirtualResource::GetAllBaselineContext
         delete[] m_ifaces;
         OCRepPayloadDestroy(m_payload);
         free(m_response);
+        for (size_t i = 0; i < m_waiters.size(); ++i)
+        {
+            free(m_waiters[i]);
+        }
     }
 };
 
+struct VirtualResource::GetAllBaselineCall
+{
+    GetAllBaselineContext *m_context;
+    const ajn::InterfaceDescription *m_iface;
+    GetAllBaselineCall(GetAllBaselineContext *context, const ajn::InterfaceDescription *iface)
+        : m_context(context), m_iface(iface) { }
+};
+
 OCDiagnosticPayload *VirtualResource::CreatePayload(ajn::Message &msg,
         OCEntityHandlerResult *ehResult)
 {
@@ -509,28 +682,122 @@ OCRepPayload *VirtualResource::CreatePayload()
     return payload;
 }
 
-OCStackResult VirtualResource::SetMemberPayload(OCRepPayload *payload,
-        const char *ifaceName, const char *memberName)
+/* Called with m_mutex held. */
+void VirtualResource::CacheProperties(const char *ifaceName, ajn::Message &msg)
+{
+    m_properties.erase(ifaceName);
+    std::map<std::string, PropertyCache>::iterator it = m_properties.insert(
+                std::make_pair(ifaceName, PropertyCache(m_bus, GetMonotonicMs()))).first;
+    it->second.Update(msg, msg->GetArg(0));
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * Invalidated properties have no value to update the cache with, so the interface is dropped
+ * from the cache until it is fetched again.
+ */
+void VirtualResource::UpdateCachedProperties(ajn::Message &msg)
 {
-    const ajn::InterfaceDescription *iface = m_bus->GetInterface(ifaceName);
-    if (!iface)
+    std::map<std::string, PropertyCache>::iterator it = m_properties.find(
+                msg->GetArg(0)->v_string.str);
+    if (it == m_properties.end())
     {
-        return OC_STACK_ERROR;
+        return;
+    }
+    if (msg->GetArg(2)->v_array.GetNumElements())
+    {
+        m_properties.erase(it);
+        return;
+    }
+    it->second.Update(msg, msg->GetArg(1));
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * Returns NULL when the GET of rt must go to the remote object.  Properties that emit a changed
+ * signal are kept current by SignalCB, the others are only used up to m_propertyMaxAgeMs old.
+ */
+OCRepPayload *VirtualResource::CreateCachedPayload(const Route *route)
+{
+    const ajn::InterfaceDescription *iface = route->m_rt->m_iface;
+    const std::string &memberName = route->m_rt->m_memberName;
+    std::map<std::string, PropertyCache>::iterator it = m_properties.find(iface->GetName());
+    if (it == m_properties.end())
+    {
+        return NULL;
+    }
+    if ((memberName == "false") &&
+            (!m_propertyMaxAgeMs || ((GetMonotonicMs() - it->second.GetTick()) > m_propertyMaxAgeMs)))
+    {
+        return NULL;
+    }
+    if (it->second.IsEmpty())
+    {
+        return CreatePayload();
+    }
+    std::vector<ajn::MsgArg> entries;
+    ajn::MsgArg dict;
+    it->second.GetValues(&dict, entries);
+    OCRepPayload *payload = NULL;
+    if (!ToFilteredOCPayload(payload, route, &dict))
+    {
+        OCRepPayloadDestroy(payload);
+        return NULL;
+    }
+    return payload ? payload : CreatePayload();
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * Filter properties based on resource type and interface requested.  When payload is NULL it is
+ * only created once a property passes the filter, so nothing is allocated for an empty result.
+ */
+bool VirtualResource::ToFilteredOCPayload(OCRepPayload *&payload, const Route *route,
+        const ajn::MsgArg *dict)
+{
+    const ajn::InterfaceDescription *iface = route->m_rt->m_iface;
+    bool success = true;
+    size_t numEntries = dict->v_array.GetNumElements();
+    for (size_t i = 0; success && i < numEntries; ++i)
+    {
+        const ajn::MsgArg *entry = &dict->v_array.GetElements()[i];
+        const char *key = entry->v_dictEntry.key->v_string.str;
+        const ajn::InterfaceDescription::Property *property = iface->GetProperty(key);
+        PropertyFilter::const_iterator it = route->m_filter.find(property);
+        if (it == route->m_filter.end())
+        {
+            continue;
+        }
+        const PropertyPlan *plan = it->second;
+        if (!plan)
+        {
+            success = false;
+            break;
+        }
+        if (!payload && !(payload = CreatePayload()))
+        {
+            success = false;
+            break;
+        }
+        success = ToOCPayload(payload, plan->m_propName.c_str(),
+                              entry->v_dictEntry.val->v_variant.val, plan->m_plan);
     }
-    const ajn::InterfaceDescription::Member *member = iface->GetMember(memberName);
-    if (!member)
+    return success;
+}
+
+OCStackResult VirtualResource::SetMemberPayload(OCRepPayload *payload, const MemberPlan *plan)
+{
+    if (!plan)
     {
         return OC_STACK_ERROR;
     }
-    qcc::String signature = member->signature + member->returnSignature;
-    size_t numArgs = CountCompleteTypes(signature.c_str());
-    const char *argNames = member->argNames.c_str();
-    std::string propName = GetPropName(member, "validity");
-    OCRepPayloadSetPropBool(payload, propName.c_str(), false);
-    for (size_t i = 0; i < numArgs; ++i)
+    OCRepPayloadSetPropBool(payload, plan->m_validity.c_str(), false);
+    for (size_t i = 0; i < plan->m_args.size(); ++i)
     {
-        propName = GetPropName(member, NextArgName(argNames, i));
-        OCRepPayloadSetNull(payload, propName.c_str());
+        OCRepPayloadSetNull(payload, plan->m_args[i].m_propName.c_str());
     }
     return OC_STACK_OK;
 }
@@ -544,40 +811,33 @@ OCEntityHandlerResult VirtualResource::EntityHandlerCB(OCEntityHandlerFlag flag,
 
     VirtualResource *resource = reinterpret_cast<VirtualResource *>(ctx);
     std::lock_guard<std::mutex> lock(resource->m_mutex);
-    std::map<std::string, std::string> queryMap = ParseQuery(request->query);
-    std::string rt = GetResourceType(queryMap, resource->m_rts.begin()->first);
-    uint8_t access = GetAccess(queryMap, resource->m_rts[rt]);
-    if (!access)
+    size_t itf;
+    const Route *route = resource->GetRoute(request->query, &itf);
+    if (!route)
     {
-        LOG(LOG_INFO, "Unsupported interface requested - %s", queryMap[OC_RSRVD_INTERFACE].c_str());
+        LOG(LOG_INFO, "Unsupported resource type or interface requested - %s", request->query);
         return OC_EH_ERROR;
     }
+    const Names::ResourceType *names = route->m_rt;
+    uint8_t access = route->m_access;
     if (flag & OC_OBSERVE_FLAG)
     {
         if (request->obsInfo.action == OC_OBSERVE_REGISTER)
         {
-            std::string ifaceName = ::GetInterface(rt);
-            const ajn::InterfaceDescription *iface = resource->GetInterface(ifaceName.c_str());
-            if (!iface)
+            const ajn::InterfaceDescription *iface = names->m_iface;
+            if (resource->AddObserver(route, request->obsInfo.obsId))
             {
-                LOG(LOG_INFO, "[%p] Observe invalid iface %s", ifaceName.c_str());
-                return OC_EH_ERROR;
-            }
-            std::vector<OCObservationId>::iterator it = std::find(resource->m_observers[request->query].begin(),
-                    resource->m_observers[request->query].end(), request->obsInfo.obsId);
-            if (it == resource->m_observers[request->query].end())
-            {
-                LOG(LOG_INFO, "[%p] Register observer rt=%s %d", resource, rt.c_str(), request->obsInfo.obsId);
-                resource->m_observers[request->query].push_back(request->obsInfo.obsId);
+                LOG(LOG_INFO, "[%p] Register observer rt=%s %d", resource, names->m_rt.c_str(),
+                        request->obsInfo.obsId);
             }
             /* Add match rule for sessionless signal */
-            std::string memberName = GetMember(rt);
-            const ajn::InterfaceDescription::Member *signal = iface->GetSignal(memberName.c_str());
-            if (signal && signal->isSessionlessSignal)
+            const std::string &memberName = names->m_memberName;
+            const ajn::InterfaceDescription::Member *signal = route->m_member;
+            if (signal && (signal->memberType == ajn::MESSAGE_SIGNAL) && signal->isSessionlessSignal)
             {
                 std::string rule = "type='signal',sender='" + std::string(resource->GetUniqueName().c_str()) +
                                    "',interface='" +
-                                   ifaceName + "',member='" + memberName + "',sessionless='t'";
+                                   iface->GetName() + "',member='" + memberName + "',sessionless='t'";
                 QStatus status = resource->m_bus->AddMatchAsync(rule.c_str(), resource);
                 if (status == ER_OK)
                 {
@@ -591,40 +851,40 @@ OCEntityHandlerResult VirtualResource::EntityHandlerCB(OCEntityHandlerFlag flag,
         }
         else if (request->obsInfo.action == OC_OBSERVE_DEREGISTER)
         {
-            for (std::map<std::string, std::vector<OCObservationId>>::iterator it =
-                     resource->m_observers.begin(); it != resource->m_observers.end(); ++it)
+            if (resource->RemoveObserver(request->obsInfo.obsId))
             {
-                for (std::vector<OCObservationId>::iterator jt = it->second.begin(); jt != it->second.end(); ++jt)
+                LOG(LOG_INFO, "[%p] Deregister observer %d", resource, request->obsInfo.obsId);
+                std::map<OCObservationId, std::string>::iterator it =
+                        resource->m_matchRules.find(request->obsInfo.obsId);
+                if (it != resource->m_matchRules.end())
                 {
-                    if (*jt == request->obsInfo.obsId)
+                    QStatus status = resource->m_bus->RemoveMatchAsync(it->second.c_str(), resource);
+                    if (status != ER_OK)
                     {
-                        LOG(LOG_INFO, "[%p] Deregister observer %s %d", resource, it->first.c_str(),
-                            request->obsInfo.obsId);
-                        if (!resource->m_matchRules[request->obsInfo.obsId].empty())
-                        {
-                            QStatus status = resource->m_bus->RemoveMatchAsync(
-                                                 resource->m_matchRules[request->obsInfo.obsId].c_str(), resource);
-                            if (status != ER_OK)
-                            {
-                                LOG(LOG_ERR, "RemoveMatchAsync - %s", QCC_StatusText(status));
-                            }
-                        }
-                        it->second.erase(jt);
-                        goto handleRequest;
+                        LOG(LOG_ERR, "RemoveMatchAsync - %s", QCC_StatusText(status));
                     }
+                    resource->m_matchRules.erase(it);
                 }
             }
         }
     }
-handleRequest:
     OCEntityHandlerResult result;
     switch (request->method)
     {
         case OC_REST_GET:
             {
-                std::string ifaceName = ::GetInterface(rt);
-                std::string memberName = GetMember(rt);
-                if (queryMap[OC_RSRVD_INTERFACE] == OC_RSRVD_INTERFACE_DEFAULT)
+                if ((itf == IF_BASELINE) && resource->m_getAllBaseline)
+                {
+                    LOG(LOG_INFO, "[%p] Sharing baseline GET context=%p", resource,
+                            resource->m_getAllBaseline);
+                    OCEntityHandlerResponse *response = (OCEntityHandlerResponse *) calloc(1,
+                            sizeof(OCEntityHandlerResponse));
+                    response->requestHandle = request->requestHandle;
+                    response->resourceHandle = request->resource;
+                    resource->m_getAllBaseline->m_waiters.push_back(response);
+                    result = OC_EH_OK;
+                }
+                else if (itf == IF_BASELINE)
                 {
                     size_t numIfaces = resource->GetInterfaces(NULL, 0);
                     const ajn::InterfaceDescription **ifaces = new const ajn::InterfaceDescription*[numIfaces];
@@ -633,6 +893,7 @@ handleRequest:
                     GetAllBaselineContext *context = new GetAllBaselineContext(resource->m_ajSoftwareVersion, ifaces,
                             numIfaces,
                             payload, request);
+                    resource->m_getAllBaseline = context;
                     QStatus status = resource->GetAllBaseline(context);
                     if (status == ER_OK)
                     {
@@ -641,26 +902,55 @@ handleRequest:
                     else
                     {
                         LOG(LOG_ERR, "GetAllBaseline - %s", QCC_StatusText(status));
+                        resource->m_getAllBaseline = NULL;
                         delete context;
                         result = OC_EH_ERROR;
                     }
                 }
-                else if (memberName == "const" || memberName == "true" || memberName == "false"
-                         || memberName == "invalidates")
+                else if (route->m_isProperties)
                 {
-                    ajn::MsgArg arg("s", ifaceName.c_str());
+                    OCRepPayload *payload = resource->CreateCachedPayload(route);
+                    if (payload)
+                    {
+                        OCEntityHandlerResponse response;
+                        memset(&response, 0, sizeof(response));
+                        response.requestHandle = request->requestHandle;
+                        response.resourceHandle = request->resource;
+                        result = OC_EH_OK;
+                        response.ehResult = result;
+                        response.payload = reinterpret_cast<OCPayload *>(payload);
+                        OCStackResult doResult = DoResponse(&response);
+                        if (doResult != OC_STACK_OK)
+                        {
+                            LOG(LOG_ERR, "DoResponse - %d", doResult);
+                            OCRepPayloadDestroy(payload);
+                        }
+                        break;
+                    }
+                    const char *ifaceName = names->m_iface->GetName();
+                    ajn::MsgArg arg("s", ifaceName);
                     const ajn::InterfaceDescription *iface = resource->m_bus->GetInterface(
                                 ::ajn::org::freedesktop::DBus::Properties::InterfaceName);
                     assert(iface);
                     const ajn::InterfaceDescription::Member *member = iface->GetMember("GetAll");
                     assert(member);
-                    MethodCallContext *context = new MethodCallContext(resource->m_ajSoftwareVersion, rt, access,
+                    MethodCallContext *context = new MethodCallContext(resource->m_ajSoftwareVersion, route,
                             member, request);
+                    std::map<std::string, MethodCallContext *>::iterator getAll =
+                            resource->m_getAlls.find(ifaceName);
+                    if (getAll != resource->m_getAlls.end())
+                    {
+                        LOG(LOG_INFO, "[%p] Sharing GetAll context=%p", resource, getAll->second);
+                        getAll->second->m_waiters.push_back(context);
+                        result = OC_EH_OK;
+                        break;
+                    }
                     QStatus status = resource->MethodCallAsync(*member, resource,
                             static_cast<ajn::MessageReceiver::ReplyHandler>(&VirtualResource::MethodReturnCB),
-                            &arg, 1, context, DefaultCallTimeout, resource->GetMethodCallFlags(ifaceName.c_str()));
+                            &arg, 1, context, DefaultCallTimeout, route->m_callFlags);
                     if (status == ER_OK)
                     {
+                        resource->m_getAlls[ifaceName] = context;
                         result = OC_EH_OK;
                     }
                     else
@@ -677,8 +967,9 @@ handleRequest:
                     response.requestHandle = request->requestHandle;
                     response.resourceHandle = request->resource;
                     OCRepPayload *payload = resource->CreatePayload();
-                    if (resource->SetMemberPayload(payload, ifaceName.c_str(), memberName.c_str()) != OC_STACK_OK)
+                    if (resource->SetMemberPayload(payload, route->m_plan) != OC_STACK_OK)
                     {
+                        OCRepPayloadDestroy(payload);
                         result = OC_EH_ERROR;
                         break;
                     }
@@ -701,19 +992,12 @@ handleRequest:
                     result = OC_EH_ERROR;
                     break;
                 }
-                std::string ifaceName = ::GetInterface(rt);
-                std::string memberName = GetMember(rt);
-                const ajn::InterfaceDescription *iface = resource->GetInterface(ifaceName.c_str());
-                if (!iface)
-                {
-                    result = OC_EH_ERROR;
-                    break;
-                }
-                if (memberName == "const")
+                const ajn::InterfaceDescription *iface = names->m_iface;
+                if (names->m_memberName == "const")
                 {
                     result = OC_EH_METHOD_NOT_ALLOWED;
                 }
-                else if (memberName == "true" || memberName == "false" || memberName == "invalidates")
+                else if (route->m_isProperties)
                 {
                     if (!request->payload || request->payload->type != PAYLOAD_TYPE_REPRESENTATION)
                     {
@@ -741,14 +1025,20 @@ handleRequest:
                 }
                 else
                 {
-                    const ajn::InterfaceDescription::Member *member = iface->GetMethod(memberName.c_str());
-                    if (!member)
+                    const ajn::InterfaceDescription::Member *member = route->m_member;
+                    if (!member || (member->memberType != ajn::MESSAGE_METHOD_CALL))
                     {
                         result = OC_EH_ERROR;
                         break;
                     }
                     bool success = true;
-                    size_t numArgs = CountCompleteTypes(member->signature.c_str());
+                    const MemberPlan *plan = route->m_plan;
+                    if (!plan)
+                    {
+                        result = OC_EH_ERROR;
+                        break;
+                    }
+                    size_t numArgs = plan->m_numInArgs;
                     ajn::MsgArg *args = NULL;
                     if (numArgs)
                     {
@@ -759,50 +1049,38 @@ handleRequest:
                             break;
                         }
                     }
-                    qcc::String propName = GetPropName(member, "validity");
                     OCRepPayload *payload = (OCRepPayload *) request->payload;
                     if (payload)
                     {
                         for (OCRepPayloadValue *value = payload->values; value; value = value->next)
                         {
-                            if (propName == value->name && (value->type != OCREP_PROP_BOOL || !value->b))
+                            if (plan->m_validity == value->name && (value->type != OCREP_PROP_BOOL || !value->b))
                             {
                                 success = false;
                                 break;
                             }
                         }
                     }
-                    const char *signature = member->signature.c_str();
-                    const char *argSignature = signature;
-                    const char *argNames = member->argNames.c_str();
                     for (size_t i = 0; success && i < numArgs; ++i)
                     {
-                        ParseCompleteType(signature);
-                        qcc::String sig(argSignature, signature - argSignature);
-                        argSignature = signature;
-                        std::string argName = NextArgName(argNames, i);
-                        if (resource->m_ajSoftwareVersion >= "v16.10.00")
-                        {
-                            member->GetArgAnnotation(argName.c_str(), "org.alljoyn.Bus.Type.Name", sig);
-                        }
-                        qcc::String propName = GetPropName(member, argName);
+                        const ArgPlan &arg = plan->m_args[i];
                         assert(payload);
                         for (OCRepPayloadValue *value = payload->values; value; value = value->next)
                         {
-                            if (propName == value->name)
+                            if (arg.m_propName == value->name)
                             {
-                                success = ToAJMsgArg(&args[i], sig.c_str(), value);
+                                success = ToAJMsgArg(&args[i], arg.m_plan, value);
                                 break;
                             }
                         }
                     }
                     if (success)
                     {
-                        MethodCallContext *context = new MethodCallContext(resource->m_ajSoftwareVersion, rt, access,
+                        MethodCallContext *context = new MethodCallContext(resource->m_ajSoftwareVersion, route,
                                 member, request);
                         QStatus status = resource->MethodCallAsync(*member,
                                          resource, static_cast<ajn::MessageReceiver::ReplyHandler>(&VirtualResource::MethodReturnCB),
-                                         args, numArgs, context);
+                                         args, numArgs, context, DefaultCallTimeout, route->m_callFlags);
                         if (status == ER_OK)
                         {
                             result = OC_EH_OK;
@@ -836,6 +1114,31 @@ void VirtualResource::MethodReturnCB(ajn::Message &msg, void *ctx)
 
     std::lock_guard<std::mutex> lock(m_mutex);
     MethodCallContext *context = reinterpret_cast<MethodCallContext *>(ctx);
+    if (!strcmp(context->m_member->iface->GetName(),
+                ajn::org::freedesktop::DBus::Properties::InterfaceName) &&
+        !strcmp(context->m_member->name.c_str(), "GetAll"))
+    {
+        const char *ifaceName = context->m_route->m_rt->m_iface->GetName();
+        m_getAlls.erase(ifaceName);
+        if (msg->GetType() == ajn::MESSAGE_METHOD_RET)
+        {
+            CacheProperties(ifaceName, msg);
+        }
+        for (size_t i = 0; i < context->m_waiters.size(); ++i)
+        {
+            SendMethodReturn(context->m_waiters[i], msg);
+        }
+    }
+    SendMethodReturn(context, msg);
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * Responds to the request of context with the reply to the call and deletes context.
+ */
+void VirtualResource::SendMethodReturn(MethodCallContext *context, ajn::Message &msg)
+{
     OCStackResult result = OC_STACK_ERROR;
     OCPayload *payload = NULL;
     switch (msg->GetType())
@@ -847,44 +1150,25 @@ void VirtualResource::MethodReturnCB(ajn::Message &msg, void *ctx)
                         ajn::org::freedesktop::DBus::Properties::InterfaceName) &&
                 !strcmp(context->m_member->name.c_str(), "GetAll"))
             {
-                const ajn::InterfaceDescription *iface =
-                        m_bus->GetInterface(::GetInterface(context->m_rt).c_str());
-                assert(iface);
-                success = ToFilteredOCPayload((OCRepPayload *) payload,
-                                              m_ajSoftwareVersion, iface,
-                                              GetMember(context->m_rt).c_str(), context->m_access,
-                                              msg->GetArg(0));
+                OCRepPayload *rep = (OCRepPayload *) payload;
+                success = ToFilteredOCPayload(rep, context->m_route, msg->GetArg(0));
             }
             else
             {
-                size_t numInArgs = CountCompleteTypes(context->m_member->signature.c_str());
+                const MemberPlan *plan = GetPlan(context->m_member);
                 size_t numOutArgs;
                 const ajn::MsgArg *outArgs;
                 msg->GetArgs(numOutArgs, outArgs);
-                std::string propName = GetPropName(context->m_member, "validity");
-                OCRepPayloadSetPropBool((OCRepPayload *) payload, propName.c_str(), true);
-                const char *argNames = context->m_member->argNames.c_str();
-                for (size_t i = 0; i < numInArgs; ++i)
+                success = plan && (plan->m_numInArgs + numOutArgs <= plan->m_args.size());
+                if (success)
                 {
-                    NextArgName(argNames, i);
+                    OCRepPayloadSetPropBool((OCRepPayload *) payload, plan->m_validity.c_str(), true);
                 }
-                success = true;
-                const char *signature = context->m_member->returnSignature.c_str();
-                const char *argSignature = signature;
                 for (size_t i = 0; success && i < numOutArgs; ++i)
                 {
-                    ParseCompleteType(signature);
-                    qcc::String sig(argSignature, signature - argSignature);
-                    argSignature = signature;
-                    std::string argName = NextArgName(argNames, numInArgs + i);
-                    if (context->m_ajSoftwareVersion >= "v16.10.00")
-                    {
-                        context->m_member->GetArgAnnotation(argName.c_str(),
-                                "org.alljoyn.Bus.Type.Name", sig);
-                    }
-                    propName = GetPropName(context->m_member, argName);
-                    success = ToOCPayload((OCRepPayload *) payload, propName.c_str(), &outArgs[i],
-                            sig.c_str());
+                    const ArgPlan &arg = plan->m_args[plan->m_numInArgs + i];
+                    success = ToOCPayload((OCRepPayload *) payload, arg.m_propName.c_str(), &outArgs[i],
+                            arg.m_plan);
                 }
             }
             if (success)
@@ -921,25 +1205,19 @@ QStatus VirtualResource::Set(SetContext *context)
     LOG(LOG_INFO, "[%p] context=%p",
         this, context);
 
-    std::string valueName = context->m_value->name;
-    std::string propName = GetMember(valueName);
-    size_t numArgs = 3;
-    ajn::MsgArg args[3];
-    args[0].Set("s", context->m_iface->GetName());
-    args[1].Set("s", propName.c_str());
-    const ajn::InterfaceDescription::Property *property = context->m_iface->GetProperty(
-                propName.c_str());
-    if (!property)
+    const Names::Property *names = m_names.GetProperty(context->m_value->name);
+    if (!names || (names->m_iface != context->m_iface))
     {
         return ER_BUS_NO_SUCH_PROPERTY;
     }
-    qcc::String signature = property->signature;
-    if (context->m_ajSoftwareVersion >= "v16.10.00")
-    {
-        property->GetAnnotation("org.alljoyn.Bus.Type.Name", signature);
-    }
+    const ajn::InterfaceDescription::Property *property = names->m_property;
+    size_t numArgs = 3;
+    ajn::MsgArg args[3];
+    args[0].Set("s", context->m_iface->GetName());
+    args[1].Set("s", property->name.c_str());
+    const PropertyPlan *plan = GetPlan(context->m_iface, property);
     ajn::MsgArg value;
-    if (!ToAJMsgArg(&value, signature.c_str(), context->m_value))
+    if (!plan || !ToAJMsgArg(&value, plan->m_plan, context->m_value))
     {
         return ER_FAIL;
     }
@@ -956,6 +1234,8 @@ void VirtualResource::SetCB(ajn::Message &msg, void *ctx)
 
     std::lock_guard<std::mutex> lock(m_mutex);
     SetContext *context = reinterpret_cast<SetContext *>(ctx);
+    /* Not all properties emit a changed signal, so fetch the interface again */
+    m_properties.erase(context->m_iface->GetName());
     OCStackResult result = OC_STACK_ERROR;
     OCRepPayload *payload = NULL;
     switch (msg->GetType())
@@ -997,102 +1277,213 @@ void VirtualResource::SetCB(ajn::Message &msg, void *ctx)
     }
 }
 
+/* Called with m_mutex held. */
+void VirtualResource::CompilePlans(const ajn::InterfaceDescription *iface)
+{
+    size_t numProps = iface->GetProperties(NULL, 0);
+    const ajn::InterfaceDescription::Property **props = new const
+            ajn::InterfaceDescription::Property*[numProps];
+    iface->GetProperties(props, numProps);
+    for (size_t i = 0; i < numProps; ++i)
+    {
+        GetPlan(iface, props[i]);
+    }
+    delete[] props;
+    size_t numMembers = iface->GetMembers(NULL, 0);
+    const ajn::InterfaceDescription::Member **members = new const
+            ajn::InterfaceDescription::Member*[numMembers];
+    iface->GetMembers(members, numMembers);
+    for (size_t i = 0; i < numMembers; ++i)
+    {
+        GetPlan(members[i]);
+    }
+    delete[] members;
+}
+
+/* Called with m_mutex held. */
+const VirtualResource::PropertyPlan *VirtualResource::GetPlan(
+    const ajn::InterfaceDescription *iface, const ajn::InterfaceDescription::Property *property)
+{
+    std::map<const ajn::InterfaceDescription::Property *, PropertyPlan>::iterator it =
+        m_propertyPlans.find(property);
+    if (it != m_propertyPlans.end())
+    {
+        return &it->second;
+    }
+    /*
+     * Annotations prior to v16.10.00 are not guaranteed to
+     * appear in the order they were specified, so are
+     * unreliable.
+     */
+    qcc::String signature = property->signature;
+    if (m_ajSoftwareVersion >= "v16.10.00")
+    {
+        property->GetAnnotation("org.alljoyn.Bus.Type.Name", signature);
+    }
+    PropertyPlan plan;
+    if (!plan.m_plan.Compile(signature.c_str(), m_types))
+    {
+        LOG(LOG_ERR, "[%p] Compile %s - %s", this, property->name.c_str(), signature.c_str());
+        return NULL;
+    }
+    qcc::String emitsChanged = (property->name == "Version") ? "const" : "false";
+    property->GetAnnotation(::ajn::org::freedesktop::DBus::AnnotateEmitsChanged, emitsChanged);
+    plan.m_emitsChanged = emitsChanged.c_str();
+    plan.m_propName = m_names.AddProperty(iface, property)->m_propName;
+    return &(m_propertyPlans[property] = plan);
+}
+
+/* Called with m_mutex held. */
+const VirtualResource::MemberPlan *VirtualResource::GetPlan(
+    const ajn::InterfaceDescription::Member *member)
+{
+    std::map<const ajn::InterfaceDescription::Member *, MemberPlan>::iterator it =
+        m_memberPlans.find(member);
+    if (it != m_memberPlans.end())
+    {
+        return &it->second;
+    }
+    MemberPlan plan;
+    plan.m_validity = GetPropName(member, "validity");
+    const char *argNames = member->argNames.c_str();
+    const char *signatures[] = { member->signature.c_str(), member->returnSignature.c_str() };
+    size_t i = 0;
+    for (size_t j = 0; j < sizeof(signatures) / sizeof(signatures[0]); ++j)
+    {
+        const char *signature = signatures[j];
+        while (*signature)
+        {
+            const char *argSignature = signature;
+            if (ParseCompleteType(signature) != ER_OK)
+            {
+                LOG(LOG_ERR, "[%p] Parse %s - %s", this, member->name.c_str(), signatures[j]);
+                return NULL;
+            }
+            qcc::String sig(argSignature, signature - argSignature);
+            std::string argName = NextArgName(argNames, i++);
+            if (m_ajSoftwareVersion >= "v16.10.00")
+            {
+                member->GetArgAnnotation(argName.c_str(), "org.alljoyn.Bus.Type.Name", sig);
+            }
+            ArgPlan arg;
+            if (!arg.m_plan.Compile(sig.c_str(), m_types))
+            {
+                LOG(LOG_ERR, "[%p] Compile %s - %s", this, member->name.c_str(), sig.c_str());
+                return NULL;
+            }
+            arg.m_propName = GetPropName(member, argName);
+            plan.m_args.push_back(arg);
+        }
+        if (j == 0)
+        {
+            plan.m_numInArgs = plan.m_args.size();
+        }
+    }
+    return &(m_memberPlans[member] = plan);
+}
+
 void VirtualResource::SignalCB(const ajn::InterfaceDescription::Member *member, const char *path,
                                ajn::Message &msg)
 {
     LOG(LOG_INFO, "[%p] member=%p,path=%s",
         this, member, path);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t flushTick;
+    std::string id;
+    std::string resourcePath;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        flushTick = TranslateSignal(msg);
+        id = GetServiceName().c_str();
+        resourcePath = GetPath().c_str();
+    }
+    /*
+     * The bridge calls FlushNotifications() with its mutex held, so this must not hold m_mutex.
+     * This resource may be destroyed while ScheduleNotify() waits for the bridge's mutex, hence
+     * the copies of its names.
+     */
+    if (flushTick != TaskQueue::NEVER)
+    {
+        m_bridge->ScheduleNotify(id.c_str(), resourcePath.c_str(), flushTick);
+    }
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * Returns the tick to call FlushNotifications() at when the changes are coalesced, otherwise
+ * TaskQueue::NEVER.
+ */
+uint64_t VirtualResource::TranslateSignal(ajn::Message &msg)
+{
+    bool isPropertiesChanged =
+        !strcmp(msg->GetInterface(), ajn::org::freedesktop::DBus::Properties::InterfaceName) &&
+        !strcmp(msg->GetMemberName(), "PropertiesChanged");
+    if (isPropertiesChanged)
+    {
+        UpdateCachedProperties(msg);
+    }
     if (m_observers.empty())
     {
         LOG(LOG_INFO, "[%p] No observers", this);
-        return;
+        return TaskQueue::NEVER;
     }
-    if (!strcmp(msg->GetInterface(), ajn::org::freedesktop::DBus::Properties::InterfaceName) &&
-        !strcmp(msg->GetMemberName(), "PropertiesChanged"))
+    if (isPropertiesChanged)
     {
         if (msg->GetArg(2)->v_array.GetNumElements())
         {
             /* Get the values of the invalidated properties */
+            const char *ifaceName = msg->GetArg(0)->v_string.str;
+            GetAllInvalidatedContext *context = new GetAllInvalidatedContext(ifaceName);
             QStatus status = MethodCallAsync(::ajn::org::freedesktop::DBus::Properties::InterfaceName,
                     "GetAll", this, static_cast<ajn::MessageReceiver::ReplyHandler>(&VirtualResource::GetAllInvalidatedCB),
-                    msg->GetArg(0), 1, NULL, DefaultCallTimeout, GetMethodCallFlags(msg->GetArg(0)->v_string.str));
+                    msg->GetArg(0), 1, context, DefaultCallTimeout, GetMethodCallFlags(ifaceName));
             if (status != ER_OK)
             {
                 LOG(LOG_ERR, "MethodCallAsync - %s", QCC_StatusText(status));
+                delete context;
             }
         }
+        else if (m_pendingChanges.IsCoalescing())
+        {
+            return m_pendingChanges.Add(msg->GetArg(0)->v_string.str, msg->GetArg(1),
+                                        GetMonotonicMs());
+        }
         else
         {
-            for (std::map<std::string, std::vector<OCObservationId>>::iterator it = m_observers.begin();
-                 it != m_observers.end(); ++it)
-            {
-                OCRepPayload *payload = CreatePayload();
-                std::map<std::string, std::string> queryMap = ParseQuery(it->first.c_str());
-                std::string rt = GetResourceType(queryMap, m_rts.begin()->first);
-                uint8_t access = GetAccess(queryMap, m_rts[rt]);
-                const ajn::InterfaceDescription *iface = m_bus->GetInterface(::GetInterface(rt).c_str());
-                assert(iface);
-                bool success = ToFilteredOCPayload(payload,
-                                                   m_ajSoftwareVersion, iface,
-                                                   GetMember(rt).c_str(), access,
-                                                   msg->GetArg(1));
-                if (success && payload->values)
-                {
-                    OCStackResult result = NotifyListOfObservers(GetPath().c_str(),
-                                           &it->second[0], it->second.size(),
-                                           payload);
-                    if (result == OC_STACK_OK)
-                    {
-                        LOG(LOG_INFO, "[%p] Notify observers rt=%s", this, it->first.c_str());
-                    }
-                    else
-                    {
-                        LOG(LOG_ERR, "[%p] Notify observers - %d", this, result);
-                        OCRepPayloadDestroy(payload);
-                    }
-                }
-            }
+            NotifyProperties(msg->GetArg(0)->v_string.str, msg->GetArg(1));
         }
     }
     else
     {
-        std::string rt = GetResourceTypeName(msg->GetInterface(), msg->GetMemberName());
-        for (std::map<std::string, std::vector<OCObservationId>>::iterator it = m_observers.begin();
-             it != m_observers.end(); ++it)
+        const Names::ResourceType *names = m_names.GetResourceType(msg->GetInterface(),
+                msg->GetMemberName());
+        if (!names)
         {
-            std::map<std::string, std::string> queryMap = ParseQuery(it->first.c_str());
-            if (rt != GetResourceType(queryMap, m_rts.begin()->first))
+            return TaskQueue::NEVER;
+        }
+        for (Observers::iterator it = m_observers.begin(); it != m_observers.end(); ++it)
+        {
+            const Route *route = it->first;
+            if (route->m_rt != names)
+            {
+                continue;
+            }
+            const MemberPlan *plan = route->m_plan;
+            if (!plan)
             {
                 continue;
             }
-            const ajn::InterfaceDescription *iface = GetInterface(msg->GetInterface());
-            assert(iface);
-            const ajn::InterfaceDescription::Member *member = iface->GetMember(msg->GetMemberName());
-            assert(member);
-            const char *argNames = member->argNames.c_str();
             size_t numArgs;
             const ajn::MsgArg *args;
             msg->GetArgs(numArgs, args);
-            std::string propName = GetPropName(member, "validity");
             OCRepPayload *payload = CreatePayload();
-            OCRepPayloadSetPropBool(payload, propName.c_str(), true);
-            bool success = true;
-            const char *signature = member->signature.c_str();
-            const char *argSignature = signature;
+            OCRepPayloadSetPropBool(payload, plan->m_validity.c_str(), true);
+            bool success = (numArgs <= plan->m_numInArgs);
             for (size_t i = 0; success && i < numArgs; ++i)
             {
-                ParseCompleteType(signature);
-                qcc::String sig(argSignature, signature - argSignature);
-                argSignature = signature;
-                std::string argName = NextArgName(argNames, i);
-                if (m_ajSoftwareVersion >= "v16.10.00")
-                {
-                    member->GetArgAnnotation(argName.c_str(), "org.alljoyn.Bus.Type.Name", sig);
-                }
-                propName = GetPropName(member, argName);
-                success = ToOCPayload(payload, propName.c_str(), &args[i], sig.c_str());
+                const ArgPlan &arg = plan->m_args[i];
+                success = ToOCPayload(payload, arg.m_propName.c_str(), &args[i], arg.m_plan);
             }
             if (success)
             {
@@ -1101,7 +1492,7 @@ void VirtualResource::SignalCB(const ajn::InterfaceDescription::Member *member,
                                        payload);
                 if (result == OC_STACK_OK)
                 {
-                    LOG(LOG_INFO, "[%p] Notify observers rt=%s", this, it->first.c_str());
+                    LOG(LOG_INFO, "[%p] Notify observers rt=%s", this, it->first->m_rt->m_rt.c_str());
                 }
                 else
                 {
@@ -1115,6 +1506,7 @@ void VirtualResource::SignalCB(const ajn::InterfaceDescription::Member *member,
             }
         }
     }
+    return TaskQueue::NEVER;
 }
 
 void VirtualResource::GetAllInvalidatedCB(ajn::Message &msg, void *ctx)
@@ -1123,164 +1515,311 @@ void VirtualResource::GetAllInvalidatedCB(ajn::Message &msg, void *ctx)
         this, ctx);
 
     std::lock_guard<std::mutex> lock(m_mutex);
-    for (std::map<std::string, std::vector<OCObservationId>>::iterator it = m_observers.begin();
-         it != m_observers.end(); ++it)
+    GetAllInvalidatedContext *context = reinterpret_cast<GetAllInvalidatedContext *>(ctx);
+    if (msg->GetType() != ajn::MESSAGE_METHOD_RET)
     {
-        OCRepPayload *payload = CreatePayload();
-        std::map<std::string, std::string> queryMap = ParseQuery(it->first.c_str());
-        std::string rt = GetResourceType(queryMap, m_rts.begin()->first);
-        uint8_t access = GetAccess(queryMap, m_rts[rt]);
-        const ajn::InterfaceDescription *iface = m_bus->GetInterface(::GetInterface(rt).c_str());
-        assert(iface);
-        bool success = ToFilteredOCPayload(payload,
-                                           m_ajSoftwareVersion, iface,
-                                           GetMember(rt).c_str(), access,
-                                           msg->GetArg(0));
-        if (success && payload->values)
+        delete context;
+        return;
+    }
+    CacheProperties(context->m_ifaceName.c_str(), msg);
+    /* The reply holds the current values of any changes still being coalesced */
+    m_pendingChanges.Erase(context->m_ifaceName.c_str());
+    NotifyProperties(context->m_ifaceName.c_str(), msg->GetArg(0));
+    delete context;
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * The properties of dict are looked up once and each of them passing the filter of an observed
+ * route is translated once, however many groups of observers select it.  The payload of each
+ * group is built from the translations held by TranslatedValues.
+ */
+void VirtualResource::NotifyProperties(const char *ifaceName, const ajn::MsgArg *dict)
+{
+    std::vector<const ajn::InterfaceDescription::Property *> properties;
+    std::vector<std::pair<Observers::iterator, Selection>> groups;
+    for (Observers::iterator it = m_observers.begin(); it != m_observers.end(); ++it)
+    {
+        const Route *route = it->first;
+        const ajn::InterfaceDescription *iface = route->m_rt->m_iface;
+        if (strcmp(iface->GetName(), ifaceName))
         {
-            OCStackResult result = NotifyListOfObservers(GetPath().c_str(),
-                                   &it->second[0], it->second.size(),
-                                   payload);
-            if (result == OC_STACK_OK)
+            continue;
+        }
+        if (properties.empty())
+        {
+            size_t numEntries = dict->v_array.GetNumElements();
+            for (size_t i = 0; i < numEntries; ++i)
             {
-                LOG(LOG_INFO, "[%p] Notify observers rt=%s", this, it->first.c_str());
+                const ajn::MsgArg *entry = &dict->v_array.GetElements()[i];
+                properties.push_back(iface->GetProperty(entry->v_dictEntry.key->v_string.str));
             }
-            else
+        }
+        Selection selection;
+        if (!Select(selection, route, properties) || selection.empty())
+        {
+            continue;
+        }
+        groups.push_back(std::make_pair(it, selection));
+    }
+    TranslatedValues values(properties.size());
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        const Selection &selection = groups[i].second;
+        for (size_t j = 0; j < selection.size(); ++j)
+        {
+            values.Use(selection[j].first);
+        }
+    }
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        Observers::iterator it = groups[i].first;
+        const Selection &selection = groups[i].second;
+        OCRepPayload *payload = CreatePayload();
+        bool success = (payload != NULL);
+        for (size_t j = 0; success && j < selection.size(); ++j)
+        {
+            size_t index = selection[j].first;
+            if (!values.IsSet(index))
             {
-                LOG(LOG_ERR, "[%p] Notify observers - %d", this, result);
-                OCRepPayloadDestroy(payload);
+                const ajn::MsgArg *entry = &dict->v_array.GetElements()[index];
+                const PropertyPlan *plan = selection[j].second;
+                OCRepPayload *holder = OCRepPayloadCreate();
+                if (holder && !ToOCPayload(holder, plan->m_propName.c_str(),
+                                           entry->v_dictEntry.val->v_variant.val, plan->m_plan))
+                {
+                    OCRepPayloadDestroy(holder);
+                    holder = NULL;
+                }
+                values.Set(index, holder);
             }
+            success = values.AddTo(payload, index);
+        }
+        if (!success)
+        {
+            OCRepPayloadDestroy(payload);
+            continue;
+        }
+        OCStackResult result = NotifyListOfObservers(GetPath().c_str(),
+                               &it->second[0], it->second.size(),
+                               payload);
+        if (result == OC_STACK_OK)
+        {
+            LOG(LOG_INFO, "[%p] Notify observers rt=%s", this, it->first->m_rt->m_rt.c_str());
         }
         else
         {
+            LOG(LOG_ERR, "[%p] Notify observers - %d", this, result);
             OCRepPayloadDestroy(payload);
         }
     }
 }
 
-/* Called with m_mutex held. */
+/*
+ * Called with m_mutex held.
+ *
+ * Returns false when a property passing the filter of route cannot be translated.
+ */
+bool VirtualResource::Select(Selection &selection, const Route *route,
+        const std::vector<const ajn::InterfaceDescription::Property *> &properties)
+{
+    selection.clear();
+    for (size_t i = 0; i < properties.size(); ++i)
+    {
+        PropertyFilter::const_iterator it = route->m_filter.find(properties[i]);
+        if (it == route->m_filter.end())
+        {
+            continue;
+        }
+        if (!it->second)
+        {
+            return false;
+        }
+        selection.push_back(std::make_pair(i, it->second));
+    }
+    return true;
+}
+
+uint64_t VirtualResource::FlushNotifications(uint64_t now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, PendingChanges::Values> due;
+    uint64_t nextTick = m_pendingChanges.Flush(now, due);
+    for (std::map<std::string, PendingChanges::Values>::iterator it = due.begin(); it != due.end();
+         ++it)
+    {
+        PendingChanges::Values &values = it->second;
+        std::vector<ajn::MsgArg> entries(values.size());
+        size_t i = 0;
+        for (PendingChanges::Values::iterator v = values.begin(); v != values.end(); ++v)
+        {
+            entries[i++].Set("{sv}", v->first.c_str(), &v->second);
+        }
+        ajn::MsgArg dict("a{sv}", entries.size(), entries.empty() ? NULL : &entries[0]);
+        NotifyProperties(it->first.c_str(), &dict);
+    }
+    return nextTick;
+}
+
+/*
+ * Called with m_mutex held.
+ *
+ * The GetAll calls of all the interfaces are made at once, the response is sent once the last
+ * of them has replied.
+ */
 QStatus VirtualResource::GetAllBaseline(GetAllBaselineContext *context)
 {
     LOG(LOG_INFO, "[%p] context=%p",
         this, context);
 
-    for (; (context->m_iface < context->m_numIfaces)
-         && (context->m_response->ehResult == OC_EH_OK); ++context->m_iface)
+    ++context->m_numPending; /* Until all the calls are made */
+    for (size_t i = 0; (i < context->m_numIfaces) && (context->m_response->ehResult == OC_EH_OK);
+         ++i)
     {
-        const char *ifaceName = context->m_ifaces[context->m_iface]->GetName();
+        const char *ifaceName = context->m_ifaces[i]->GetName();
         if (!TranslateInterface(ifaceName))
         {
             continue;
         }
-        size_t numProps = context->m_ifaces[context->m_iface]->GetProperties(NULL, 0);
+        size_t numProps = context->m_ifaces[i]->GetProperties(NULL, 0);
         if (numProps)
         {
             ajn::MsgArg arg("s", ifaceName);
+            GetAllBaselineCall *call = new GetAllBaselineCall(context, context->m_ifaces[i]);
             QStatus status = MethodCallAsync(::ajn::org::freedesktop::DBus::Properties::InterfaceName,
                     "GetAll", this, static_cast<ajn::MessageReceiver::ReplyHandler>(&VirtualResource::GetAllBaselineCB),
-                    &arg, 1, context, DefaultCallTimeout, GetMethodCallFlags(ifaceName));
-            if (status != ER_OK)
+                    &arg, 1, call, DefaultCallTimeout, GetMethodCallFlags(ifaceName));
+            if (status == ER_OK)
+            {
+                ++context->m_numPending;
+            }
+            else
             {
                 LOG(LOG_ERR, "MethodCallAsync - %s", QCC_StatusText(status));
+                delete call;
                 context->m_response->ehResult = OC_EH_ERROR;
             }
-            break;
         }
     }
-    if ((context->m_response->ehResult != OC_EH_OK) || (context->m_iface == context->m_numIfaces))
+    if (--context->m_numPending == 0)
     {
-        if (context->m_response->ehResult == OC_EH_OK)
+        SendGetAllBaselineResponse(context);
+    }
+    return ER_OK;
+}
+
+/* Called with m_mutex held. */
+void VirtualResource::SendGetAllBaselineResponse(GetAllBaselineContext *context)
+{
+    LOG(LOG_INFO, "[%p] context=%p",
+        this, context);
+
+    if (m_getAllBaseline == context)
+    {
+        m_getAllBaseline = NULL;
+    }
+
+    if (context->m_response->ehResult == OC_EH_OK)
+    {
+        for (size_t i = 0; (i < context->m_numIfaces) && (context->m_response->ehResult == OC_EH_OK); ++i)
         {
-            for (size_t i = 0; (i < context->m_numIfaces) && (context->m_response->ehResult == OC_EH_OK); ++i)
+            const char *ifaceName = context->m_ifaces[i]->GetName();
+            if (!TranslateInterface(ifaceName))
             {
-                const char *ifaceName = context->m_ifaces[i]->GetName();
-                if (!TranslateInterface(ifaceName))
-                {
-                    continue;
-                }
-                size_t numMembers = context->m_ifaces[i]->GetMembers(NULL, 0);
-                const ajn::InterfaceDescription::Member **members = new const
-                ajn::InterfaceDescription::Member*[numMembers];
-                context->m_ifaces[i]->GetMembers(members, numMembers);
-                for (size_t j = 0; (j < numMembers) && (context->m_response->ehResult == OC_EH_OK); ++j)
+                continue;
+            }
+            size_t numMembers = context->m_ifaces[i]->GetMembers(NULL, 0);
+            const ajn::InterfaceDescription::Member **members = new const
+            ajn::InterfaceDescription::Member*[numMembers];
+            context->m_ifaces[i]->GetMembers(members, numMembers);
+            for (size_t j = 0; (j < numMembers) && (context->m_response->ehResult == OC_EH_OK); ++j)
+            {
+                if (SetMemberPayload(context->m_payload, GetPlan(members[j])) != OC_STACK_OK)
                 {
-                    if (SetMemberPayload(context->m_payload, ifaceName, members[j]->name.c_str()) != OC_STACK_OK)
-                    {
-                        context->m_response->ehResult = OC_EH_ERROR;
-                    }
+                    context->m_response->ehResult = OC_EH_ERROR;
                 }
-                delete[] members;
             }
+            delete[] members;
         }
-        /* Common properties */
-        const char **rts = NULL;
-        const char **ifs = NULL;
-        if (context->m_response->ehResult == OC_EH_OK)
+    }
+    /* Common properties */
+    const char **rts = NULL;
+    const char **ifs = NULL;
+    if (context->m_response->ehResult == OC_EH_OK)
+    {
+        size_t dim[MAX_REP_ARRAY_DEPTH] = {0, 0, 0};
+        uint8_t nrts = 0;
+        OCStackResult result = OCGetNumberOfResourceTypes(context->m_response->resourceHandle, &nrts);
+        if (result != OC_STACK_OK)
         {
-            size_t dim[MAX_REP_ARRAY_DEPTH] = {0, 0, 0};
-            uint8_t nrts = 0;
-            OCStackResult result = OCGetNumberOfResourceTypes(context->m_response->resourceHandle, &nrts);
-            if (result != OC_STACK_OK)
-            {
-                context->m_response->ehResult = OC_EH_ERROR;
-                goto exit;
-            }
-            dim[0] = nrts;
-            rts = (const char **)OICMalloc(sizeof(const char *) * nrts);
-            if (rts == NULL)
-            {
-                context->m_response->ehResult = OC_EH_ERROR;
-                goto exit;
-            }
-            for (size_t i = 0; i < nrts; ++i)
-            {
-                rts[i] = OCGetResourceTypeName(context->m_response->resourceHandle, i);
-            }
-            if (!OCRepPayloadSetStringArray(context->m_payload, OC_RSRVD_RESOURCE_TYPE, (const char **)rts,
-                                            dim))
-            {
-                context->m_response->ehResult = OC_EH_ERROR;
-                goto exit;
-            }
-            uint8_t nifs = 0;
-            result = OCGetNumberOfResourceInterfaces(context->m_response->resourceHandle, &nifs);
-            if (result != OC_STACK_OK)
-            {
-                context->m_response->ehResult = OC_EH_ERROR;
-                goto exit;
-            }
-            dim[0] = nifs;
-            ifs = (const char **)OICMalloc(sizeof(const char *) * nifs);
-            if (ifs == NULL)
-            {
-                context->m_response->ehResult = OC_EH_ERROR;
-                goto exit;
-            }
-            for (size_t i = 0; i < nifs; ++i)
-            {
-                ifs[i] = OCGetResourceInterfaceName(context->m_response->resourceHandle, i);
-            }
-            if (!OCRepPayloadSetStringArray(context->m_payload, OC_RSRVD_INTERFACE, (const char **)ifs, dim))
-            {
-                context->m_response->ehResult = OC_EH_ERROR;
-                goto exit;
-            }
+            context->m_response->ehResult = OC_EH_ERROR;
+            goto exit;
         }
-exit:
-        if (context->m_response->ehResult == OC_EH_OK)
+        dim[0] = nrts;
+        rts = (const char **)OICMalloc(sizeof(const char *) * nrts);
+        if (rts == NULL)
+        {
+            context->m_response->ehResult = OC_EH_ERROR;
+            goto exit;
+        }
+        for (size_t i = 0; i < nrts; ++i)
         {
-            context->m_response->payload = reinterpret_cast<OCPayload *>(context->m_payload);
+            rts[i] = OCGetResourceTypeName(context->m_response->resourceHandle, i);
         }
-        OCStackResult doResult = DoResponse(context->m_response);
+        if (!OCRepPayloadSetStringArray(context->m_payload, OC_RSRVD_RESOURCE_TYPE, (const char **)rts,
+                                        dim))
+        {
+            context->m_response->ehResult = OC_EH_ERROR;
+            goto exit;
+        }
+        uint8_t nifs = 0;
+        result = OCGetNumberOfResourceInterfaces(context->m_response->resourceHandle, &nifs);
+        if (result != OC_STACK_OK)
+        {
+            context->m_response->ehResult = OC_EH_ERROR;
+            goto exit;
+        }
+        dim[0] = nifs;
+        ifs = (const char **)OICMalloc(sizeof(const char *) * nifs);
+        if (ifs == NULL)
+        {
+            context->m_response->ehResult = OC_EH_ERROR;
+            goto exit;
+        }
+        for (size_t i = 0; i < nifs; ++i)
+        {
+            ifs[i] = OCGetResourceInterfaceName(context->m_response->resourceHandle, i);
+        }
+        if (!OCRepPayloadSetStringArray(context->m_payload, OC_RSRVD_INTERFACE, (const char **)ifs, dim))
+        {
+            context->m_response->ehResult = OC_EH_ERROR;
+            goto exit;
+        }
+    }
+exit:
+    if (context->m_response->ehResult == OC_EH_OK)
+    {
+        context->m_response->payload = reinterpret_cast<OCPayload *>(context->m_payload);
+    }
+    OCStackResult doResult = DoResponse(context->m_response);
+    if (doResult != OC_STACK_OK)
+    {
+        LOG(LOG_ERR, "DoResponse - %d", doResult);
+    }
+    for (size_t i = 0; i < context->m_waiters.size(); ++i)
+    {
+        context->m_waiters[i]->ehResult = context->m_response->ehResult;
+        context->m_waiters[i]->payload = context->m_response->payload;
+        doResult = DoResponse(context->m_waiters[i]);
         if (doResult != OC_STACK_OK)
         {
             LOG(LOG_ERR, "DoResponse - %d", doResult);
         }
-        OICFree(ifs);
-        OICFree(rts);
-        delete context;
     }
-    return ER_OK;
+    OICFree(ifs);
+    OICFree(rts);
+    delete context;
 }
 
 void VirtualResource::GetAllBaselineCB(ajn::Message &msg, void *ctx)
@@ -1289,61 +1828,55 @@ void VirtualResource::GetAllBaselineCB(ajn::Message &msg, void *ctx)
         this, ctx);
 
     std::lock_guard<std::mutex> lock(m_mutex);
-    GetAllBaselineContext *context = reinterpret_cast<GetAllBaselineContext *>(ctx);
-    switch (msg->GetType())
+    GetAllBaselineCall *call = reinterpret_cast<GetAllBaselineCall *>(ctx);
+    GetAllBaselineContext *context = call->m_context;
+    const ajn::InterfaceDescription *iface = call->m_iface;
+    delete call;
+    /* Only the first error is reported */
+    if (context->m_response->ehResult == OC_EH_OK)
     {
-        case ajn::MESSAGE_METHOD_RET:
-            {
-                const ajn::InterfaceDescription *iface = context->m_ifaces[context->m_iface];
-                const ajn::MsgArg *dict = msg->GetArg(0);
-                bool success = true;
-                size_t numEntries = dict->v_array.GetNumElements();
-                for (size_t i = 0; success && i < numEntries; ++i)
+        switch (msg->GetType())
+        {
+            case ajn::MESSAGE_METHOD_RET:
                 {
-                    const ajn::MsgArg *entry = &dict->v_array.GetElements()[i];
-                    const char *key = entry->v_dictEntry.key->v_string.str;
-                    const ajn::InterfaceDescription::Property *property = iface->GetProperty(key);
-                    if (property)
+                    const ajn::MsgArg *dict = msg->GetArg(0);
+                    CacheProperties(iface->GetName(), msg);
+                    bool success = true;
+                    size_t numEntries = dict->v_array.GetNumElements();
+                    for (size_t i = 0; success && i < numEntries; ++i)
                     {
-                        /*
-                         * Annotations prior to v16.10.00 are not guaranteed to
-                         * appear in the order they were specified, so are
-                         * unreliable.
-                         */
-                        qcc::String signature = property->signature;
-                        if (context->m_ajSoftwareVersion >= "v16.10.00")
+                        const ajn::MsgArg *entry = &dict->v_array.GetElements()[i];
+                        const char *key = entry->v_dictEntry.key->v_string.str;
+                        const ajn::InterfaceDescription::Property *property = iface->GetProperty(key);
+                        if (property)
                         {
-                            property->GetAnnotation("org.alljoyn.Bus.Type.Name", signature);
+                            const PropertyPlan *plan = GetPlan(iface, property);
+                            success = plan && ToOCPayload(context->m_payload, plan->m_propName.c_str(),
+                                                          entry->v_dictEntry.val->v_variant.val, plan->m_plan);
                         }
-                        qcc::String propName = GetPropName(iface, key);
-                        success = ToOCPayload(context->m_payload, propName.c_str(), entry->v_dictEntry.val->v_variant.val,
-                                              signature.c_str());
                     }
+                    if (success)
+                    {
+                        context->m_response->ehResult = OC_EH_OK;
+                    }
+                    else
+                    {
+                        context->m_response->ehResult = OC_EH_ERROR;
+                    }
+                    break;
                 }
-                if (success)
-                {
-                    context->m_response->ehResult = OC_EH_OK;
-                }
-                else
-                {
-                    context->m_response->ehResult = OC_EH_ERROR;
-                }
+            case ajn::MESSAGE_ERROR:
+                context->m_response->payload = (OCPayload *) CreatePayload(msg,
+                        &context->m_response->ehResult);
                 break;
-            }
-        case ajn::MESSAGE_ERROR:
-            context->m_response->payload = (OCPayload *) CreatePayload(msg,
-                    &context->m_response->ehResult);
-            break;
-        default:
-            assert(0);
-            break;
+            default:
+                assert(0);
+                break;
+        }
     }
-    ++context->m_iface;
-    QStatus status = GetAllBaseline(context);
-    if (status != ER_OK)
+    if (--context->m_numPending == 0)
     {
-        LOG(LOG_ERR, "GetAllBaseline - %s", QCC_StatusText(status));
-        delete context;
+        SendGetAllBaselineResponse(context);
     }
 }
 
@@ -21,15 +21,21 @@
 #ifndef _VIRTUALRESOURCE_H
 #define _VIRTUALRESOURCE_H
 
+#include "Name.h"
+#include "Payload.h"
+#include "PendingChanges.h"
+#include "PropertyCache.h"
 #include "cacommon.h"
 #include "octypes.h"
 #include <inttypes.h>
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/ProxyBusObject.h>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 class Bridge;
+class IntrospectionCache;
 
 class VirtualResource : public ajn::ProxyBusObject
     , protected ajn::ProxyBusObject::Listener
@@ -37,9 +43,34 @@ class VirtualResource : public ajn::ProxyBusObject
     , private ajn::BusAttachment::RemoveMatchAsyncCB
 {
     public:
+        /*
+         * When cache is not NULL the introspection XML of the object is looked up by piid, path
+         * and softwareVersion, and the remote object is only introspected when it is missing.
+         */
         static VirtualResource *Create(Bridge *bridge, ajn::BusAttachment *bus, const char *name,
-                ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion);
+                ajn::SessionId sessionId, const char *path, const char *ajSoftwareVersion,
+                IntrospectionCache *cache = NULL, const char *piid = NULL,
+                const char *softwareVersion = NULL);
         virtual ~VirtualResource();
+        /* True when the resources were created from cached introspection data by Create(). */
+        bool IsFromCache() const { return m_fromCache; }
+        /*
+         * GETs of properties that do not emit a changed signal are answered from values fetched
+         * at most maxAgeMs ago.  The default of 0 fetches them on every GET.
+         */
+        void SetPropertyMaxAge(uint32_t maxAgeMs);
+        /*
+         * PropertiesChanged signals of an interface received within windowMs of each other are
+         * coalesced into one notification of the latest values, sent at most maxLatencyMs (or
+         * windowMs if greater) after the first of them.  The default windowMs of 0 notifies
+         * observers of every signal.
+         */
+        void SetNotifyCoalescing(uint32_t windowMs, uint32_t maxLatencyMs);
+        /* Sends the coalesced notifications due by now, returns when the next one is due. */
+        uint64_t FlushNotifications(uint64_t now);
+
+        /* The interfaces a request may be routed by, IF_NONE when the query has none. */
+        enum { IF_NONE = 0, IF_BASELINE, IF_READ_WRITE, IF_READ, NUM_INTERFACES };
 
     protected:
         std::mutex m_mutex;
@@ -51,31 +82,116 @@ class VirtualResource : public ajn::ProxyBusObject
 
     private:
         std::string m_ajSoftwareVersion;
+        IntrospectionCache *m_cache;
+        std::string m_cacheId;
+        std::string m_cacheVersion;
+        bool m_fromCache;
         std::map<std::string, uint8_t> m_rts;
-        std::map<std::string, std::vector<OCObservationId>> m_observers;
+        Names m_names; /* Of the resource types and properties in m_rts */
         std::map<OCObservationId, std::string> m_matchRules;
+        std::shared_ptr<const Types> m_types; /* Declared by the interfaces of this object */
+        struct PropertyPlan
+        {
+            std::string m_propName;
+            std::string m_emitsChanged;
+            TranslationPlan m_plan;
+        };
+        std::map<const ajn::InterfaceDescription::Property *, PropertyPlan> m_propertyPlans;
+        struct ArgPlan
+        {
+            std::string m_propName;
+            TranslationPlan m_plan;
+        };
+        struct MemberPlan
+        {
+            std::string m_validity; /* Property name of the validity flag */
+            std::vector<ArgPlan> m_args; /* The args of signature then those of returnSignature */
+            size_t m_numInArgs; /* Number of args of signature */
+        };
+        std::map<const ajn::InterfaceDescription::Member *, MemberPlan> m_memberPlans;
+        /* The properties in a payload of a route and their plans */
+        typedef std::unordered_map<const ajn::InterfaceDescription::Property *,
+                const PropertyPlan *> PropertyFilter;
+        /* How a request with an rt and if query is translated, prepared by CreateRoutes() */
+        struct Route
+        {
+            const Names::ResourceType *m_rt;
+            uint8_t m_access; /* NONE when the interface is not supported */
+            bool m_isProperties; /* The properties with an EmitsChanged value of m_rt */
+            PropertyFilter m_filter; /* When m_isProperties */
+            uint8_t m_callFlags; /* Of calls to m_rt->m_iface */
+            const ajn::InterfaceDescription::Member *m_member; /* Method or signal of m_rt */
+            const MemberPlan *m_plan; /* Of m_member */
+        };
+        struct Routes
+        {
+            Route m_route[NUM_INTERFACES];
+        };
+        std::unordered_map<std::string, Routes> m_routes; /* Indexed by rt */
+        std::unordered_map<std::string, Routes>::iterator m_defaultRoutes; /* When no rt is given */
+        /* Observers are grouped by the route they registered with, as each group is notified of
+         * the same payload */
+        typedef std::map<const Route *, std::vector<OCObservationId>> Observers;
+        Observers m_observers;
+        struct Observer
+        {
+            const Route *m_route;
+            size_t m_index; /* In m_observers[m_route] */
+        };
+        std::unordered_map<OCObservationId, Observer> m_observerIds;
+        /* From GetAll, updated by PropertiesChanged */
+        std::map<std::string, PropertyCache> m_properties; /* Indexed by interface name */
+        uint32_t m_propertyMaxAgeMs;
+        PendingChanges m_pendingChanges; /* Flushed by FlushNotifications() */
+        struct MethodCallContext;
+        /* The GetAll calls of GETs in flight, indexed by interface name */
+        std::map<std::string, MethodCallContext *> m_getAlls;
+        struct GetAllBaselineContext;
+        GetAllBaselineContext *m_getAllBaseline; /* The baseline GET in flight */
 
         OCStackResult Create();
         uint8_t GetMethodCallFlags(const char *ifaceName);
         void IntrospectCB(ajn::Message &msg, void *ctx);
         OCStackResult CreateResources();
+        void CompilePlans(const ajn::InterfaceDescription *iface);
+        const PropertyPlan *GetPlan(const ajn::InterfaceDescription *iface,
+                const ajn::InterfaceDescription::Property *property);
+        const MemberPlan *GetPlan(const ajn::InterfaceDescription::Member *member);
+        void CreateRoutes();
+        void CreateFilter(PropertyFilter &filter, const ajn::InterfaceDescription *iface,
+                const char *emitsChangedValue, uint8_t access);
+        const Route *GetRoute(const char *query, size_t *itf = NULL);
+        bool AddObserver(const Route *route, OCObservationId id);
+        bool RemoveObserver(OCObservationId id);
+        bool ToFilteredOCPayload(OCRepPayload *&payload, const Route *route,
+                const ajn::MsgArg *dict);
+        /* The indices of the dictionary entries passing the filter of a route and their plans */
+        typedef std::vector<std::pair<size_t, const PropertyPlan *>> Selection;
+        bool Select(Selection &selection, const Route *route,
+                const std::vector<const ajn::InterfaceDescription::Property *> &properties);
         void SignalCB(const ajn::InterfaceDescription::Member *member, const char *path,
                 ajn::Message &msg);
+        uint64_t TranslateSignal(ajn::Message &msg);
+        void NotifyProperties(const char *ifaceName, const ajn::MsgArg *dict);
         void MethodReturnCB(ajn::Message &msg, void *context);
+        void SendMethodReturn(MethodCallContext *context, ajn::Message &msg);
         struct SetContext;
         QStatus Set(SetContext *context);
         void SetCB(ajn::Message &msg, void *context);
         struct GetAllInvalidatedContext;
         void GetAllInvalidatedCB(ajn::Message &msg, void *ctx);
-        struct GetAllBaselineContext;
+        struct GetAllBaselineCall;
         QStatus GetAllBaseline(GetAllBaselineContext *context);
         void GetAllBaselineCB(ajn::Message &msg, void *ctx);
+        void SendGetAllBaselineResponse(GetAllBaselineContext *context);
         virtual void AddMatchCB(QStatus status, void *ctx);
         virtual void RemoveMatchCB(QStatus status, void *ctx);
         OCDiagnosticPayload *CreatePayload(ajn::Message &msg, OCEntityHandlerResult *ehResult);
         OCRepPayload *CreatePayload();
-        OCStackResult SetMemberPayload(OCRepPayload *payload, const char *ifaceName,
-                const char *memberName);
+        void CacheProperties(const char *ifaceName, ajn::Message &msg);
+        void UpdateCachedProperties(ajn::Message &msg);
+        OCRepPayload *CreateCachedPayload(const Route *route);
+        OCStackResult SetMemberPayload(OCRepPayload *payload, const MemberPlan *plan);
         static OCEntityHandlerResult EntityHandlerCB(OCEntityHandlerFlag flag,
                 OCEntityHandlerRequest *request, void *context);
 };
@@ -0,0 +1,430 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/*
+ * Measures the translation between AllJoyn values and OC payloads, and the property cache that
+ * GETs of virtual resources are answered from.
+ *
+ * Usage: AllJoynBridgeBenchmark [--filter SUBSTRING] [--json FILE]
+ *
+ * Each benchmark is repeated until it has run for at least MIN_DURATION_NS and ns/op and
+ * allocations/op are reported.  The JSON results can be kept to compare one commit to another.
+ */
+
+#include "Introspection.h"
+#include "Payload.h"
+#include "PropertyCache.h"
+#include "Signature.h"
+#include "ocpayload.h"
+#include <alljoyn/Init.h>
+#include <alljoyn/MsgArg.h>
+#include <chrono>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+ * The OC stack allocates with malloc() and operator new ends up there too, so replacing the C
+ * allocator entry points counts both.  This relies on glibc, as does the rest of the unit tests.
+ */
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t nmemb, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static size_t sAllocs = 0; /* The benchmarks are single threaded */
+
+extern "C" void *malloc(size_t size) throw()
+{
+    ++sAllocs;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size) throw()
+{
+    ++sAllocs;
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) throw()
+{
+    ++sAllocs;
+    return __libc_realloc(ptr, size);
+}
+
+void LogWriteln(const char *file, const char *function, int32_t line, int8_t severity,
+        const char *fmt, ...)
+{
+    (void) file;
+    (void) function;
+    (void) line;
+    (void) severity;
+    (void) fmt;
+}
+
+static const uint64_t MIN_DURATION_NS = 200000000;
+static const size_t MATRIX_DIM = 32;
+static const size_t LARGE_BYTES = 64 * 1024;
+
+/* A value of each type in the corpus, as an AllJoyn value and as the OC value translated from it */
+struct Corpus
+{
+    const char *m_name;
+    const char *m_signature;
+    ajn::MsgArg m_arg;
+    OCRepPayload *m_payload; /* Holds m_value */
+    OCRepPayloadValue *m_value;
+    TranslationPlan m_plan;
+    ajn::MsgArg m_entry;
+    ajn::MsgArg m_dict; /* m_arg as property "value" of an a{sv} */
+    PropertyCache *m_cache; /* Holds m_dict */
+};
+
+static std::shared_ptr<const Types> sTypes;
+static std::vector<Corpus *> sCorpus;
+static ajn::BusAttachment *sBus;
+static ajn::Message *sMsg; /* Stands in for the GetAll reply holding the cached values */
+
+static void CreateDictionary(ajn::MsgArg *arg)
+{
+    const char *tags[] = { "kitchen", "ceiling", "dimmable" };
+    ajn::MsgArg values[5];
+    values[0].Set("s", "Living room");
+    values[1].Set("q", 200);
+    values[2].Set("d", 0.75);
+    values[3].Set("b", true);
+    values[4].Set("as", 3, tags);
+    const char *names[] = { "name", "brightness", "level", "on", "tags" };
+    ajn::MsgArg entries[5];
+    for (size_t i = 0; i < 5; ++i)
+    {
+        entries[i].Set("{sv}", names[i], &values[i]);
+    }
+    arg->Set("a{sv}", 5, entries);
+    arg->Stabilize();
+}
+
+static void CreateMatrix(ajn::MsgArg *arg)
+{
+    double samples[MATRIX_DIM];
+    ajn::MsgArg rows[MATRIX_DIM];
+    for (size_t i = 0; i < MATRIX_DIM; ++i)
+    {
+        for (size_t j = 0; j < MATRIX_DIM; ++j)
+        {
+            samples[j] = i + j / 8.0;
+        }
+        rows[i].Set("ad", MATRIX_DIM, samples);
+        rows[i].Stabilize();
+    }
+    arg->Set("aad", MATRIX_DIM, rows);
+    arg->Stabilize();
+}
+
+static void CreateBytes(ajn::MsgArg *arg)
+{
+    std::vector<uint8_t> bytes(LARGE_BYTES);
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        bytes[i] = i;
+    }
+    arg->Set("ay", bytes.size(), &bytes[0]);
+    arg->Stabilize();
+}
+
+static Corpus *CreateCorpus(const char *name, const char *signature)
+{
+    Corpus *corpus = new Corpus();
+    corpus->m_name = name;
+    corpus->m_signature = signature;
+    if (!strcmp(signature, "a{sv}"))
+    {
+        CreateDictionary(&corpus->m_arg);
+    }
+    else if (!strcmp(signature, "aad"))
+    {
+        CreateMatrix(&corpus->m_arg);
+    }
+    else if (!strcmp(signature, "ay"))
+    {
+        CreateBytes(&corpus->m_arg);
+    }
+    else if (!strcmp(signature, "(i(sd)(b(yq)))"))
+    {
+        corpus->m_arg.Set(signature, -1, "nested", 2.5, true, 7, 300);
+    }
+    else if (!strcmp(signature, "[Point]"))
+    {
+        corpus->m_arg.Set("(dd)", 1.25, -3.5);
+    }
+    else if (!strcmp(signature, "y"))
+    {
+        corpus->m_arg.Set(signature, 2);
+    }
+    corpus->m_payload = OCRepPayloadCreate();
+    if (!corpus->m_plan.Compile(signature, sTypes) ||
+            !ToOCPayload(corpus->m_payload, "value", &corpus->m_arg, signature, sTypes.get()))
+    {
+        fprintf(stderr, "Failed to create %s\n", name);
+        exit(EXIT_FAILURE);
+    }
+    corpus->m_value = corpus->m_payload->values;
+    corpus->m_entry.Set("{sv}", "value", &corpus->m_arg);
+    corpus->m_dict.Set("a{sv}", 1, &corpus->m_entry);
+    corpus->m_cache = new PropertyCache(sBus, 0);
+    corpus->m_cache->Update(*sMsg, &corpus->m_dict);
+    return corpus;
+}
+
+static void Setup()
+{
+    if (AllJoynInit() != ER_OK)
+    {
+        fprintf(stderr, "AllJoynInit failed\n");
+        exit(EXIT_FAILURE);
+    }
+    sBus = new ajn::BusAttachment("AllJoynBridgeBenchmark");
+    sMsg = new ajn::Message(*sBus);
+    Types::Structs structs;
+    structs["[Point]"].push_back(Types::Field("x", "d"));
+    structs["[Point]"].push_back(Types::Field("y", "d"));
+    sTypes.reset(new Types(structs));
+    sCorpus.push_back(CreateCorpus("dictionary", "a{sv}"));
+    sCorpus.push_back(CreateCorpus("nested struct", "(i(sd)(b(yq)))"));
+    sCorpus.push_back(CreateCorpus("named struct", "[Point]"));
+    sCorpus.push_back(CreateCorpus("matrix", "aad"));
+    sCorpus.push_back(CreateCorpus("large bytes", "ay"));
+    sCorpus.push_back(CreateCorpus("byte", "y"));
+}
+
+static void ToOCPayloadBySignature(Corpus *corpus)
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ToOCPayload(payload, "value", &corpus->m_arg, corpus->m_signature, sTypes.get());
+    OCRepPayloadDestroy(payload);
+}
+
+static void ToOCPayloadByPlan(Corpus *corpus)
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ToOCPayload(payload, "value", &corpus->m_arg, corpus->m_plan);
+    OCRepPayloadDestroy(payload);
+}
+
+static void ToAJMsgArgBySignature(Corpus *corpus)
+{
+    ajn::MsgArg arg;
+    ToAJMsgArg(&arg, corpus->m_signature, corpus->m_value, sTypes.get());
+}
+
+static void ToAJMsgArgByPlan(Corpus *corpus)
+{
+    ajn::MsgArg arg;
+    ToAJMsgArg(&arg, corpus->m_plan, corpus->m_value);
+}
+
+/* A PropertiesChanged of the value, replacing the cached one */
+static void PropertyCacheUpdate(Corpus *corpus)
+{
+    corpus->m_cache->Update(*sMsg, &corpus->m_dict);
+}
+
+/* A GET answered from the cache, as VirtualResource::CreateCachedPayload() */
+static void PropertyCacheGet(Corpus *corpus)
+{
+    std::vector<ajn::MsgArg> entries;
+    ajn::MsgArg dict;
+    corpus->m_cache->GetValues(&dict, entries);
+    const ajn::MsgArg *entry = &dict.v_array.GetElements()[0];
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ToOCPayload(payload, "value", entry->v_dictEntry.val->v_variant.val, corpus->m_plan);
+    OCRepPayloadDestroy(payload);
+}
+
+static void CreateSignature(Corpus *corpus)
+{
+    char sig[] = "aaaa{sv}";
+    CreateSignature(sig, corpus->m_value);
+}
+
+static const char *sSignatures[] =
+{
+    "a{sv}", "(i(sd)(b(yq)))", "aad", "ay", "a{s(dd)}", "aa{sv}", "(sa(ii)a{ys})", "v"
+};
+
+static void ParseCompleteType(Corpus *corpus)
+{
+    (void) corpus;
+    for (size_t i = 0; i < sizeof(sSignatures) / sizeof(sSignatures[0]); ++i)
+    {
+        const char *signature = sSignatures[i];
+        ParseCompleteType(signature);
+    }
+}
+
+/* An introspection fragment with an enum-annotated type */
+static const char sJson[] =
+    "{\"definitions\":{\"Mode\":{\"enum\":[0,1,2,3],\"title\":\"Mode\",\"type\":\"integer\"},"
+    "\"Thermostat\":{\"properties\":{\"mode\":{\"$ref\":\"#/definitions/Mode\"},"
+    "\"setpoint\":{\"type\":\"number\",\"minimum\":5.0,\"maximum\":35.0},"
+    "\"rt\":{\"type\":\"array\",\"items\":{\"type\":\"string\"},\"readOnly\":true}},"
+    "\"required\":[\"mode\",\"setpoint\"]}}}";
+
+static void ParsePayload(Corpus *corpus)
+{
+    (void) corpus;
+    OCPayload *payload = NULL;
+    if (ParsePayload(&payload, OC_FORMAT_JSON, PAYLOAD_TYPE_REPRESENTATION,
+            (const uint8_t *) sJson, sizeof(sJson)) == OC_STACK_OK)
+    {
+        OCPayloadDestroy(payload);
+    }
+}
+
+struct Benchmark
+{
+    const char *m_name;
+    void (*m_run)(Corpus *corpus);
+    bool m_perCorpus; /* Run once for each corpus entry, otherwise once */
+};
+
+static const Benchmark sBenchmarks[] =
+{
+    { "ToOCPayload/signature", ToOCPayloadBySignature, true },
+    { "ToOCPayload/plan", ToOCPayloadByPlan, true },
+    { "ToAJMsgArg/signature", ToAJMsgArgBySignature, true },
+    { "ToAJMsgArg/plan", ToAJMsgArgByPlan, true },
+    { "PropertyCache/update", PropertyCacheUpdate, true },
+    { "PropertyCache/get", PropertyCacheGet, true },
+    { "CreateSignature", CreateSignature, true },
+    { "ParseCompleteType", ParseCompleteType, false },
+    { "ParsePayload", ParsePayload, false },
+};
+
+struct Result
+{
+    std::string m_name;
+    uint64_t m_iterations;
+    double m_nsPerOp;
+    double m_allocsPerOp;
+};
+
+static Result Measure(std::string name, void (*run)(Corpus *corpus), Corpus *corpus)
+{
+    run(corpus); /* Warm up */
+    uint64_t iterations = 1;
+    for (;;)
+    {
+        size_t allocs = sAllocs;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            run(corpus);
+        }
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - begin).count();
+        allocs = sAllocs - allocs;
+        if (ns >= MIN_DURATION_NS)
+        {
+            Result result;
+            result.m_name = name;
+            result.m_iterations = iterations;
+            result.m_nsPerOp = (double) ns / iterations;
+            result.m_allocsPerOp = (double) allocs / iterations;
+            return result;
+        }
+        iterations *= 2;
+    }
+}
+
+static bool WriteJson(const char *fileName, const std::vector<Result> &results)
+{
+    FILE *fp = fopen(fileName, "w");
+    if (!fp)
+    {
+        return false;
+    }
+    fprintf(fp, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        fprintf(fp, "    {\"name\": \"%s\", \"iterations\": %" PRIu64 ", \"ns_per_op\": %.1f, "
+                "\"allocs_per_op\": %.2f}%s\n", results[i].m_name.c_str(), results[i].m_iterations,
+                results[i].m_nsPerOp, results[i].m_allocsPerOp,
+                (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    return (fclose(fp) == 0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = NULL;
+    const char *jsonFileName = NULL;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--filter") && (i + 1 < argc))
+        {
+            filter = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--json") && (i + 1 < argc))
+        {
+            jsonFileName = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--filter SUBSTRING] [--json FILE]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Setup();
+    std::vector<Result> results;
+    printf("%-40s %14s %14s\n", "benchmark", "ns/op", "allocs/op");
+    for (size_t i = 0; i < sizeof(sBenchmarks) / sizeof(sBenchmarks[0]); ++i)
+    {
+        const Benchmark &benchmark = sBenchmarks[i];
+        size_t numRuns = benchmark.m_perCorpus ? sCorpus.size() : 1;
+        for (size_t j = 0; j < numRuns; ++j)
+        {
+            Corpus *corpus = benchmark.m_perCorpus ? sCorpus[j] : NULL;
+            std::string name = benchmark.m_name;
+            if (corpus)
+            {
+                name = name + "/" + corpus->m_name;
+            }
+            if (filter && (name.find(filter) == std::string::npos))
+            {
+                continue;
+            }
+            Result result = Measure(name, benchmark.m_run, corpus);
+            printf("%-40s %14.1f %14.2f\n", result.m_name.c_str(), result.m_nsPerOp,
+                    result.m_allocsPerOp);
+            results.push_back(result);
+        }
+    }
+    if (jsonFileName && !WriteJson(jsonFileName, results))
+    {
+        fprintf(stderr, "Failed to write %s\n", jsonFileName);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -20,7 +20,27 @@
 
 #include <gtest/gtest.h>
 
+#include "Executor.h"
+#include "IntrospectionCache.h"
 #include "Name.h"
+#include "Payload.h"
+#include "PendingChanges.h"
+#include "Presence.h"
+#include "PropertyCache.h"
+#include "Registry.h"
+#include "TaskQueue.h"
+#include "TranslatedValues.h"
+#include "VirtualBusAttachment.h"
+#include "VirtualDevice.h"
+#include "ocpayload.h"
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Init.h>
+#include <alljoyn/Status.h>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
 
 class NameTranslationTest : public ::testing::TestWithParam<const char *> { };
 
@@ -57,6 +77,112 @@ TEST(NameTranslationTest, BoundsCheck)
     EXPECT_STREQ("example.foo__", ToAJName("x.example.foo---").c_str());
 }
 
+TEST(NameTranslationTest, ResourceTypes)
+{
+    std::string rt = GetResourceTypeName("example.my_Widget", "SetLevel");
+    EXPECT_STREQ("x.example.my---widget.-set-level", rt.c_str());
+    EXPECT_STREQ("example.my_Widget", GetInterface(rt).c_str());
+    EXPECT_STREQ("SetLevel", GetMember(rt).c_str());
+    EXPECT_STREQ("x.example.widget", GetResourceTypeName("example.widget").c_str());
+}
+
+TEST(NameTranslationTest, NextArgName)
+{
+    const char *argNames = "level,,duration";
+    EXPECT_STREQ("level", NextArgName(argNames, 0).c_str());
+    EXPECT_STREQ("arg1", NextArgName(argNames, 1).c_str());
+    EXPECT_STREQ("duration", NextArgName(argNames, 2).c_str());
+    EXPECT_STREQ("arg3", NextArgName(argNames, 3).c_str());
+    EXPECT_STREQ("", argNames);
+}
+
+class NamesTest : public ::testing::Test
+{
+    protected:
+        static const size_t NUM_IFACES = 64;
+        ajn::BusAttachment *m_bus;
+        std::vector<const ajn::InterfaceDescription *> m_ifaces;
+
+        virtual void SetUp()
+        {
+            ASSERT_EQ(ER_OK, AllJoynInit());
+            m_bus = new ajn::BusAttachment("NamesTest");
+            for (size_t i = 0; i < NUM_IFACES; ++i)
+            {
+                std::string ifaceName = "example.Widget" + std::to_string(i);
+                ajn::InterfaceDescription *iface = NULL;
+                ASSERT_EQ(ER_OK, m_bus->CreateInterface(ifaceName.c_str(), iface,
+                        ajn::AJ_IFC_SECURITY_INHERIT));
+                ASSERT_EQ(ER_OK, iface->AddProperty("Level", "i", ajn::PROP_ACCESS_RW));
+                ASSERT_EQ(ER_OK, iface->AddMethod("SetLevel", "i", "", "level", 0));
+                iface->Activate();
+                m_ifaces.push_back(iface);
+            }
+        }
+        virtual void TearDown()
+        {
+            delete m_bus;
+            AllJoynShutdown();
+        }
+};
+
+TEST_F(NamesTest, LookupByEveryKey)
+{
+    Names names;
+    std::vector<const Names::ResourceType *> rts;
+    std::vector<const Names::ResourceType *> ifaceRts;
+    std::vector<const Names::Property *> props;
+    /* Enough entries that the indexes rehash while the keys still point into the entries */
+    for (const ajn::InterfaceDescription *iface : m_ifaces)
+    {
+        rts.push_back(names.AddResourceType(iface, "SetLevel"));
+        ifaceRts.push_back(names.AddResourceType(iface, NULL));
+        props.push_back(names.AddProperty(iface, iface->GetProperty("Level")));
+    }
+    for (size_t i = 0; i < m_ifaces.size(); ++i)
+    {
+        const ajn::InterfaceDescription *iface = m_ifaces[i];
+        std::string rt = GetResourceTypeName(iface, "SetLevel");
+        ASSERT_TRUE(rts[i] != NULL);
+        EXPECT_EQ(iface, rts[i]->m_iface);
+        EXPECT_STREQ("SetLevel", rts[i]->m_memberName.c_str());
+        EXPECT_STREQ(rt.c_str(), rts[i]->m_rt.c_str());
+        EXPECT_EQ(rts[i], names.GetResourceType(rt.c_str()));
+        EXPECT_EQ(rts[i], names.GetResourceType(iface->GetName(), "SetLevel"));
+
+        ASSERT_TRUE(ifaceRts[i] != NULL);
+        EXPECT_STREQ(GetResourceTypeName(iface->GetName()).c_str(), ifaceRts[i]->m_rt.c_str());
+        EXPECT_EQ(ifaceRts[i], names.GetResourceType(ifaceRts[i]->m_rt.c_str()));
+        EXPECT_EQ(ifaceRts[i], names.GetResourceType(iface->GetName(), ""));
+
+        std::string propName = GetPropName(iface, "Level");
+        ASSERT_TRUE(props[i] != NULL);
+        EXPECT_EQ(iface, props[i]->m_iface);
+        EXPECT_EQ(iface->GetProperty("Level"), props[i]->m_property);
+        EXPECT_STREQ(propName.c_str(), props[i]->m_propName.c_str());
+        EXPECT_EQ(props[i], names.GetProperty(propName.c_str()));
+    }
+    EXPECT_TRUE(names.GetResourceType("x.example.widget") == NULL);
+    EXPECT_TRUE(names.GetResourceType("example.Widget0", "GetLevel") == NULL);
+    EXPECT_TRUE(names.GetResourceType("example.Gadget", "SetLevel") == NULL);
+    EXPECT_TRUE(names.GetProperty("x.example.-widget0.-volume") == NULL);
+}
+
+TEST_F(NamesTest, DuplicateAddReturnsSameEntry)
+{
+    Names names;
+    const ajn::InterfaceDescription *iface = m_ifaces[0];
+    const Names::ResourceType *rt = names.AddResourceType(iface, "SetLevel");
+    const Names::ResourceType *ifaceRt = names.AddResourceType(iface, NULL);
+    const Names::Property *prop = names.AddProperty(iface, iface->GetProperty("Level"));
+    EXPECT_NE(rt, ifaceRt);
+    EXPECT_EQ(rt, names.AddResourceType(iface, "SetLevel"));
+    EXPECT_EQ(ifaceRt, names.AddResourceType(iface, NULL));
+    EXPECT_EQ(prop, names.AddProperty(iface, iface->GetProperty("Level")));
+    EXPECT_EQ(rt, names.GetResourceType(rt->m_rt.c_str()));
+    EXPECT_EQ(prop, names.GetProperty(prop->m_propName.c_str()));
+}
+
 TEST(IsValidErrorNameTest, Check)
 {
     const char *endp;
@@ -79,3 +205,692 @@ TEST(IsValidErrorNameTest, Check)
     EXPECT_TRUE(IsValidErrorName("a.b ", &endp) && (*endp == ' '));
     EXPECT_TRUE(IsValidErrorName("a.b:", &endp) && (*endp == ':'));
 }
+
+class TestTask : public TaskQueue::Task
+{
+    public:
+        TestTask(int id) : m_id(id) { }
+        int m_id;
+};
+
+TEST(TaskQueueTest, PopsInTickOrder)
+{
+    TaskQueue queue;
+    TestTask a(0), b(1), c(2);
+    queue.Schedule(&a, 30);
+    queue.Schedule(&b, 10);
+    queue.Schedule(&c, 20);
+    EXPECT_EQ(10u, queue.GetNextTick());
+    EXPECT_TRUE(queue.Pop(9) == NULL);
+    EXPECT_EQ(&b, queue.Pop(30));
+    EXPECT_EQ(&c, queue.Pop(30));
+    EXPECT_EQ(&a, queue.Pop(30));
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_EQ(TaskQueue::NEVER, queue.GetNextTick());
+}
+
+TEST(TaskQueueTest, RescheduleAndCancel)
+{
+    TaskQueue queue;
+    TestTask a(0), b(1), c(2);
+    queue.Schedule(&a, 10);
+    queue.Schedule(&b, 20);
+    queue.Schedule(&c, 30);
+    queue.Schedule(&a, 40);
+    EXPECT_EQ(20u, queue.GetNextTick());
+    queue.Schedule(&c, 5);
+    EXPECT_EQ(5u, queue.GetNextTick());
+    EXPECT_TRUE(queue.Cancel(&b));
+    EXPECT_FALSE(b.IsScheduled());
+    EXPECT_FALSE(queue.Cancel(&b));
+    EXPECT_EQ(2u, queue.Size());
+    EXPECT_EQ(&c, queue.Pop(100));
+    EXPECT_EQ(&a, queue.Pop(100));
+    EXPECT_TRUE(queue.Pop(100) == NULL);
+}
+
+TEST(TaskQueueTest, ManyTasks)
+{
+    const int n = 1000;
+    TaskQueue queue;
+    std::vector<TestTask *> tasks;
+    for (int i = 0; i < n; ++i)
+    {
+        tasks.push_back(new TestTask(i));
+        queue.Schedule(tasks.back(), (i * 7919) % n);
+    }
+    for (int i = 0; i < n; i += 2)
+    {
+        EXPECT_TRUE(queue.Cancel(tasks[i]));
+        delete tasks[i];
+    }
+    uint64_t tick = 0;
+    TaskQueue::Task *task;
+    while ((task = queue.Pop(n)) != NULL)
+    {
+        EXPECT_LE(tick, task->GetTick());
+        EXPECT_EQ(1, static_cast<TestTask *>(task)->m_id % 2);
+        tick = task->GetTick();
+        delete task;
+    }
+    EXPECT_TRUE(queue.Empty());
+}
+
+class TestWork : public Executor::Work
+{
+    public:
+        TestWork(std::mutex &mutex, std::vector<int> &order, std::atomic<int> &running,
+                std::atomic<int> &maxRunning, int id)
+            : m_mutex(mutex), m_order(order), m_running(running), m_maxRunning(maxRunning),
+              m_id(id) { }
+        virtual void Run()
+        {
+            int running = ++m_running;
+            int maxRunning = m_maxRunning;
+            while ((running > maxRunning) &&
+                    !m_maxRunning.compare_exchange_weak(maxRunning, running))
+            {
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_order.push_back(m_id);
+            }
+            --m_running;
+        }
+    private:
+        std::mutex &m_mutex;
+        std::vector<int> &m_order;
+        std::atomic<int> &m_running;
+        std::atomic<int> &m_maxRunning;
+        int m_id;
+};
+
+TEST(ExecutorTest, StrandRunsInOrder)
+{
+    const int n = 1000;
+    std::mutex mutex;
+    std::vector<int> order;
+    std::atomic<int> running(0);
+    std::atomic<int> maxRunning(0);
+    {
+        Executor executor(4);
+        for (int i = 0; i < n; ++i)
+        {
+            executor.Post("key", new TestWork(mutex, order, running, maxRunning, i));
+        }
+        for (bool done = false; !done; std::this_thread::yield())
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = (order.size() == n);
+        }
+    }
+    EXPECT_EQ(1, maxRunning.load());
+    for (int i = 0; i < n; ++i)
+    {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(ExecutorTest, StrandsRunIndependently)
+{
+    const int numKeys = 16;
+    const int n = 100;
+    std::mutex mutex;
+    std::vector<int> order;
+    std::atomic<int> running(0);
+    std::atomic<int> maxRunning(0);
+    {
+        Executor executor(4);
+        EXPECT_EQ(4u, executor.GetNumThreads());
+        for (int i = 0; i < n; ++i)
+        {
+            for (int k = 0; k < numKeys; ++k)
+            {
+                executor.Post(std::to_string(k), new TestWork(mutex, order, running, maxRunning,
+                        k * n + i));
+            }
+        }
+        for (bool done = false; !done; std::this_thread::yield())
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = (order.size() == numKeys * n);
+        }
+    }
+    EXPECT_LE(maxRunning.load(), 4);
+    std::vector<int> next(numKeys, 0);
+    for (int id : order)
+    {
+        EXPECT_EQ(next[id / n], id % n);
+        ++next[id / n];
+    }
+}
+
+static FILE *PSOpenCB(const char *path, const char *mode)
+{
+    return fopen(path, mode);
+}
+
+static OCPersistentStorage sPS = { PSOpenCB, fread, fwrite, fclose, unlink };
+
+TEST(IntrospectionCacheTest, RoundTrip)
+{
+    const char *fileName = "IntrospectionCacheTest.dat";
+    std::string json = "{\n  \"paths\": {}\n}\n";
+    std::string xml = "<node name=\"/Light\"></node>";
+    std::string data;
+    {
+        IntrospectionCache cache(fileName);
+        EXPECT_TRUE(cache.Load(&sPS));
+        EXPECT_EQ(0u, cache.Size());
+        cache.Put("di", "1.0", json);
+        cache.Put("piid/Light", "2.0", xml);
+        EXPECT_TRUE(cache.Save(&sPS));
+    }
+    IntrospectionCache cache(fileName);
+    EXPECT_TRUE(cache.Load(&sPS));
+    EXPECT_EQ(2u, cache.Size());
+    EXPECT_TRUE(cache.Get("di", "1.0", data));
+    EXPECT_EQ(json, data);
+    EXPECT_TRUE(cache.Get("piid/Light", "2.0", data));
+    EXPECT_EQ(xml, data);
+    EXPECT_FALSE(cache.Get("di", "1.1", data));
+    EXPECT_FALSE(cache.Get("piid/Dark", "2.0", data));
+    unlink(fileName);
+}
+
+TEST(IntrospectionCacheTest, DamagedEntryIsDropped)
+{
+    const char *fileName = "IntrospectionCacheTest.dat";
+    std::string data;
+    {
+        IntrospectionCache cache(fileName);
+        cache.Put("a", "1.0", "AAAA");
+        cache.Put("b", "1.0", "BBBB");
+        EXPECT_TRUE(cache.Save(&sPS));
+    }
+    std::string s;
+    {
+        FILE *fp = fopen(fileName, "rb");
+        ASSERT_TRUE(fp != NULL);
+        char buf[256];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        {
+            s.append(buf, n);
+        }
+        fclose(fp);
+    }
+    size_t pos = s.find("AAAA");
+    ASSERT_NE(std::string::npos, pos);
+    s[pos] = 'X';
+    {
+        FILE *fp = fopen(fileName, "wb");
+        ASSERT_TRUE(fp != NULL);
+        fwrite(s.c_str(), 1, s.size(), fp);
+        fclose(fp);
+    }
+    IntrospectionCache cache(fileName);
+    EXPECT_TRUE(cache.Load(&sPS));
+    EXPECT_FALSE(cache.Get("a", "1.0", data));
+    EXPECT_TRUE(cache.Get("b", "1.0", data));
+    EXPECT_EQ("BBBB", data);
+    unlink(fileName);
+}
+
+TEST(PropertyCacheTest, LargeByteArraysAreNotCopied)
+{
+    ASSERT_EQ(ER_OK, AllJoynInit());
+    {
+        ajn::BusAttachment bus("PropertyCacheTest");
+        ajn::Message msg(bus);
+        std::vector<uint8_t> large(PropertyCache::BORROW_MIN_BYTES, 0xa5);
+        std::vector<uint8_t> small(16, 0x5a);
+        ajn::MsgArg values[2];
+        values[0].Set("ay", large.size(), &large[0]);
+        values[1].Set("ay", small.size(), &small[0]);
+        ajn::MsgArg entries[2];
+        entries[0].Set("{sv}", "Large", &values[0]);
+        entries[1].Set("{sv}", "Small", &values[1]);
+        ajn::MsgArg dict("a{sv}", 2, entries);
+
+        PropertyCache cache(&bus, 0);
+        cache.Update(msg, &dict);
+        const ajn::MsgArg *value = cache.GetValue("Large");
+        ASSERT_TRUE(value != NULL);
+        EXPECT_EQ(&large[0], value->v_scalarArray.v_byte);
+        value = cache.GetValue("Small");
+        ASSERT_TRUE(value != NULL);
+        EXPECT_NE(&small[0], value->v_scalarArray.v_byte);
+        EXPECT_EQ(small.size(), value->v_scalarArray.numElements);
+
+        /* A GET refers to the cached values */
+        std::vector<ajn::MsgArg> getEntries;
+        ajn::MsgArg get;
+        cache.GetValues(&get, getEntries);
+        ASSERT_EQ(2u, get.v_array.GetNumElements());
+        const ajn::MsgArg *entry = &get.v_array.GetElements()[0];
+        EXPECT_STREQ("Large", entry->v_dictEntry.key->v_string.str);
+        EXPECT_EQ(&large[0], entry->v_dictEntry.val->v_variant.val->v_scalarArray.v_byte);
+
+        /* A smaller value replacing a borrowed one is copied */
+        small.assign(16, 0x3c);
+        entries[0].Set("{sv}", "Large", &values[1]);
+        ajn::MsgArg changed("a{sv}", 1, entries);
+        cache.Update(msg, &changed);
+        value = cache.GetValue("Large");
+        ASSERT_TRUE(value != NULL);
+        EXPECT_NE(&small[0], value->v_scalarArray.v_byte);
+        EXPECT_EQ(0x3c, value->v_scalarArray.v_byte[0]);
+    }
+    AllJoynShutdown();
+}
+
+class PayloadTest : public ::testing::Test
+{
+    protected:
+        std::shared_ptr<const Types> m_types;
+
+        virtual void SetUp()
+        {
+            Types::Structs structs;
+            structs["[Point]"].push_back(Types::Field("x", "d"));
+            structs["[Point]"].push_back(Types::Field("y", "d"));
+            m_types.reset(new Types(structs));
+        }
+
+        /* Translates arg to a payload and back again, both by signature and by plan. */
+        void ExpectRoundTrip(const char *signature, const ajn::MsgArg &arg)
+        {
+            SCOPED_TRACE(signature);
+            TranslationPlan plan;
+            ASSERT_TRUE(plan.Compile(signature, m_types));
+
+            OCRepPayload *payload = OCRepPayloadCreate();
+            ajn::MsgArg bySignature;
+            EXPECT_TRUE(ToOCPayload(payload, "value", &arg, signature, m_types.get()) &&
+                        ToAJMsgArg(&bySignature, signature, payload->values, m_types.get()));
+            EXPECT_TRUE(arg == bySignature);
+            OCRepPayloadDestroy(payload);
+
+            payload = OCRepPayloadCreate();
+            ajn::MsgArg byPlan;
+            EXPECT_TRUE(ToOCPayload(payload, "value", &arg, plan) &&
+                        ToAJMsgArg(&byPlan, plan, payload->values));
+            EXPECT_TRUE(arg == byPlan);
+            OCRepPayloadDestroy(payload);
+        }
+
+        void ExpectRejected(const char *signature, OCRepPayloadValue *value)
+        {
+            SCOPED_TRACE(signature);
+            TranslationPlan plan;
+            ASSERT_TRUE(plan.Compile(signature, m_types));
+            ajn::MsgArg bySignature;
+            EXPECT_FALSE(ToAJMsgArg(&bySignature, signature, value, m_types.get()));
+            ajn::MsgArg byPlan;
+            EXPECT_FALSE(ToAJMsgArg(&byPlan, plan, value));
+        }
+};
+
+TEST_F(PayloadTest, DoubleMatrixRoundTrip)
+{
+    double samples[2][3] = { { 0.5, -1.25, 3 }, { 1e100, -0.0, 42.125 } };
+    ajn::MsgArg rows[2];
+    rows[0].Set("ad", 3, samples[0]);
+    rows[1].Set("ad", 3, samples[1]);
+    ajn::MsgArg arg("aad", 2, rows);
+    ExpectRoundTrip("aad", arg);
+}
+
+TEST_F(PayloadTest, Int64MatrixRoundTrip)
+{
+    int64_t samples[2][3] = { { INT64_MIN, -1, 0 }, { 1, MAX_SAFE_INTEGER + 1, INT64_MAX } };
+    ajn::MsgArg rows[2];
+    rows[0].Set("ax", 3, samples[0]);
+    rows[1].Set("ax", 3, samples[1]);
+    ajn::MsgArg arg("aax", 2, rows);
+    ExpectRoundTrip("aax", arg);
+}
+
+TEST_F(PayloadTest, BytesRoundTrip)
+{
+    uint8_t bytes[256];
+    for (size_t i = 0; i < 256; ++i)
+    {
+        bytes[i] = i;
+    }
+    ajn::MsgArg arg("ay", 256, bytes);
+    ExpectRoundTrip("ay", arg);
+}
+
+TEST_F(PayloadTest, StructRoundTrip)
+{
+    ajn::MsgArg arg("(is(bd))", -7, "seven", true, 7.5);
+    ExpectRoundTrip("(is(bd))", arg);
+    ajn::MsgArg point("(dd)", 1.25, -3.5);
+    ExpectRoundTrip("[Point]", point);
+}
+
+TEST_F(PayloadTest, PropertiesRoundTrip)
+{
+    ajn::MsgArg values[4];
+    values[0].Set("s", "Living room");
+    values[1].Set("i", -200);
+    values[2].Set("d", 0.75);
+    values[3].Set("b", true);
+    const char *names[] = { "name", "offset", "level", "on" };
+    ajn::MsgArg entries[4];
+    for (size_t i = 0; i < 4; ++i)
+    {
+        entries[i].Set("{sv}", names[i], &values[i]);
+    }
+    ajn::MsgArg arg("a{sv}", 4, entries);
+    ExpectRoundTrip("a{sv}", arg);
+}
+
+TEST_F(PayloadTest, DictionaryRoundTrip)
+{
+    ajn::MsgArg entries[3];
+    entries[0].Set("{ys}", 1, "one");
+    entries[1].Set("{ys}", 2, "two");
+    entries[2].Set("{ys}", 255, "many");
+    ajn::MsgArg arg("a{ys}", 3, entries);
+    ExpectRoundTrip("a{ys}", arg);
+
+    int64_t values[2] = { INT64_MIN, INT64_MAX };
+    ajn::MsgArg stringEntries[2];
+    stringEntries[0].Set("{sx}", "min", values[0]);
+    stringEntries[1].Set("{sx}", "max", values[1]);
+    ajn::MsgArg stringArg("a{sx}", 2, stringEntries);
+    ExpectRoundTrip("a{sx}", stringArg);
+}
+
+TEST_F(PayloadTest, OutOfRangeRowIsRejected)
+{
+    int64_t values[2][2] = { { 1, 2 }, { 3, 40000 } };
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = { 2, 2, 0 };
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ASSERT_TRUE(OCRepPayloadSetIntArray(payload, "value", &values[0][0], dimensions));
+    ExpectRejected("aan", payload->values);
+    ExpectRejected("aay", payload->values);
+    ajn::MsgArg arg;
+    EXPECT_TRUE(ToAJMsgArg(&arg, "aai", payload->values));
+
+    values[1][1] = 256;
+    ASSERT_TRUE(OCRepPayloadSetIntArray(payload, "value", &values[0][0], dimensions));
+    ExpectRejected("aay", payload->values);
+    values[1][1] = -1;
+    ASSERT_TRUE(OCRepPayloadSetIntArray(payload, "value", &values[0][0], dimensions));
+    ExpectRejected("aaq", payload->values);
+    OCRepPayloadDestroy(payload);
+}
+
+TEST_F(PayloadTest, ArrayOfNullsIsRejected)
+{
+    const char *signatures[] = { "ab", "ay", "an", "aq", "ai", "au", "ax", "at", "ad" };
+    OCRepPayloadValue value;
+    memset(&value, 0, sizeof(value));
+    value.name = (char *) "value";
+    value.type = OCREP_PROP_ARRAY;
+    value.arr.type = OCREP_PROP_NULL;
+    value.arr.dimensions[0] = 2;
+    for (size_t i = 0; i < sizeof(signatures) / sizeof(signatures[0]); ++i)
+    {
+        ExpectRejected(signatures[i], &value);
+    }
+    value.arr.dimensions[1] = 2;
+    ExpectRejected("aax", &value);
+    ExpectRejected("aad", &value);
+}
+
+TEST_F(PayloadTest, EmptyRowIsRejected)
+{
+    const char *signatures[] = { "aai", "aax", "aad", "aab" };
+    int32_t i32[2] = { 1, 2 };
+    int64_t i64[2] = { 1, 2 };
+    double d[2] = { 1, 2 };
+    bool b[2] = { true, false };
+    ajn::MsgArg rows[4];
+    rows[0].Set("ai", 2, i32);
+    rows[1].Set("ax", 2, i64);
+    rows[2].Set("ad", 2, d);
+    rows[3].Set("ab", 2, b);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        SCOPED_TRACE(signatures[i]);
+        TranslationPlan plan;
+        ASSERT_TRUE(plan.Compile(signatures[i], m_types));
+        ajn::MsgArg empty;
+        empty.Set(&signatures[i][1], 0, &i64[0]);
+        ajn::MsgArg firstEmpty[2] = { empty, rows[i] };
+        ajn::MsgArg lastEmpty[2] = { rows[i], empty };
+        ajn::MsgArg args[2];
+        args[0].Set(signatures[i], 2, firstEmpty);
+        args[1].Set(signatures[i], 2, lastEmpty);
+        OCRepPayload *payload = OCRepPayloadCreate();
+        for (size_t j = 0; j < 2; ++j)
+        {
+            EXPECT_FALSE(ToOCPayload(payload, "value", &args[j], signatures[i], m_types.get()));
+            EXPECT_FALSE(ToOCPayload(payload, "value", &args[j], plan));
+        }
+        EXPECT_TRUE(payload->values == NULL);
+        OCRepPayloadDestroy(payload);
+    }
+}
+
+TEST(TranslatedValuesTest, LastPayloadIsGivenTheTranslation)
+{
+    OCRepPayload *holder = OCRepPayloadCreate();
+    ASSERT_TRUE(OCRepPayloadSetPropString(holder, "name", "kitchen"));
+    OCRepPayloadValue *translation = holder->values;
+    TranslatedValues values(2);
+    values.Use(0);
+    values.Use(0);
+    values.Use(1);
+    EXPECT_FALSE(values.IsSet(0));
+    values.Set(0, holder);
+    values.Set(1, NULL);
+    EXPECT_TRUE(values.IsSet(0));
+    EXPECT_TRUE(values.IsSet(1));
+
+    OCRepPayload *first = OCRepPayloadCreate();
+    EXPECT_TRUE(values.AddTo(first, 0));
+    ASSERT_TRUE(first->values != NULL);
+    EXPECT_NE(translation, first->values);
+    EXPECT_STREQ("name", first->values->name);
+    EXPECT_STREQ("kitchen", first->values->str);
+
+    /* Added after the values already in the payload */
+    OCRepPayload *last = OCRepPayloadCreate();
+    ASSERT_TRUE(OCRepPayloadSetPropInt(last, "level", 1));
+    EXPECT_TRUE(values.AddTo(last, 0));
+    ASSERT_TRUE(last->values != NULL);
+    EXPECT_EQ(translation, last->values->next);
+    EXPECT_TRUE(translation->next == NULL);
+
+    /* A value that cannot be translated */
+    EXPECT_FALSE(values.AddTo(last, 1));
+    OCRepPayloadDestroy(first);
+    OCRepPayloadDestroy(last);
+}
+
+/* Adds a change of the value of one property of ifaceName received at now */
+static uint64_t AddChange(PendingChanges &changes, const char *ifaceName, const char *name,
+        int32_t value, uint64_t now)
+{
+    ajn::MsgArg arg("i", value);
+    ajn::MsgArg entry("{sv}", name, &arg);
+    ajn::MsgArg dict("a{sv}", 1, &entry);
+    return changes.Add(ifaceName, &dict, now);
+}
+
+TEST(PendingChangesTest, NotCoalescingByDefault)
+{
+    PendingChanges changes;
+    EXPECT_FALSE(changes.IsCoalescing());
+    changes.SetWindow(100, 1000);
+    EXPECT_TRUE(changes.IsCoalescing());
+}
+
+TEST(PendingChangesTest, FlushedWhenIdleForWindow)
+{
+    PendingChanges changes;
+    changes.SetWindow(100, 1000);
+    std::map<std::string, PendingChanges::Values> due;
+    EXPECT_EQ(100u, AddChange(changes, "a.b", "Level", 1, 0));
+    EXPECT_EQ(100u, changes.Flush(99, due));
+    EXPECT_TRUE(due.empty());
+    /* A flush is already scheduled */
+    EXPECT_EQ(TaskQueue::NEVER, AddChange(changes, "a.b", "Level", 2, 50));
+    EXPECT_EQ(150u, changes.Flush(100, due));
+    EXPECT_TRUE(due.empty());
+    EXPECT_EQ(TaskQueue::NEVER, changes.Flush(150, due));
+    ASSERT_EQ(1u, due.size());
+    PendingChanges::Values &values = due["a.b"];
+    ASSERT_EQ(1u, values.size());
+    EXPECT_EQ(2, values["Level"].v_int32);
+
+    /* Nothing is scheduled after the last flush */
+    due.clear();
+    EXPECT_EQ(300u, AddChange(changes, "a.b", "Level", 3, 200));
+}
+
+TEST(PendingChangesTest, FlushedByMaxLatency)
+{
+    PendingChanges changes;
+    changes.SetWindow(100, 250);
+    std::map<std::string, PendingChanges::Values> due;
+    EXPECT_EQ(100u, AddChange(changes, "a.b", "Level", 1, 0));
+    EXPECT_EQ(TaskQueue::NEVER, AddChange(changes, "a.b", "Level", 2, 80));
+    EXPECT_EQ(180u, changes.Flush(100, due));
+    EXPECT_EQ(TaskQueue::NEVER, AddChange(changes, "a.b", "On", 1, 160));
+    EXPECT_EQ(250u, changes.Flush(200, due));
+    EXPECT_TRUE(due.empty());
+    EXPECT_EQ(TaskQueue::NEVER, AddChange(changes, "a.b", "Level", 3, 240));
+    EXPECT_EQ(TaskQueue::NEVER, changes.Flush(250, due));
+    ASSERT_EQ(1u, due.size());
+    EXPECT_EQ(2u, due["a.b"].size());
+    EXPECT_EQ(3, due["a.b"]["Level"].v_int32);
+
+    /* A max latency shorter than the window is the window */
+    changes.SetWindow(100, 10);
+    EXPECT_EQ(1100u, AddChange(changes, "a.b", "Level", 4, 1000));
+}
+
+TEST(PendingChangesTest, InterfacesAreFlushedSeparately)
+{
+    PendingChanges changes;
+    changes.SetWindow(100, 1000);
+    std::map<std::string, PendingChanges::Values> due;
+    EXPECT_EQ(100u, AddChange(changes, "a.b", "Level", 1, 0));
+    EXPECT_EQ(TaskQueue::NEVER, AddChange(changes, "c.d", "Level", 2, 60));
+    EXPECT_EQ(160u, changes.Flush(100, due));
+    ASSERT_EQ(1u, due.size());
+    EXPECT_EQ(1u, due.count("a.b"));
+    due.clear();
+    EXPECT_EQ(TaskQueue::NEVER, changes.Flush(160, due));
+    ASSERT_EQ(1u, due.size());
+    EXPECT_EQ(1u, due.count("c.d"));
+}
+
+TEST(PendingChangesTest, EraseDropsChanges)
+{
+    PendingChanges changes;
+    changes.SetWindow(100, 1000);
+    std::map<std::string, PendingChanges::Values> due;
+    EXPECT_EQ(100u, AddChange(changes, "a.b", "Level", 1, 0));
+    EXPECT_EQ(TaskQueue::NEVER, AddChange(changes, "c.d", "Level", 2, 0));
+    /* As when the reply to a GetAll of invalidated properties holds the current values */
+    changes.Erase("a.b");
+    EXPECT_EQ(TaskQueue::NEVER, changes.Flush(100, due));
+    ASSERT_EQ(1u, due.size());
+    EXPECT_EQ(1u, due.count("c.d"));
+    due.clear();
+    changes.Erase("c.d");
+    EXPECT_EQ(TaskQueue::NEVER, changes.Flush(1000, due));
+    EXPECT_TRUE(due.empty());
+}
+
+class TestPresence : public Presence
+{
+    public:
+        TestPresence(const std::string &id) : Presence(id) { }
+        virtual bool IsPresent() { return true; }
+        virtual void Seen() { }
+};
+
+TEST(RegistryTest, FindByEveryIndex)
+{
+    ASSERT_EQ(ER_OK, AllJoynInit());
+    ASSERT_EQ(ER_OK, AllJoynRouterInit());
+    {
+        Registry registry;
+        VirtualBusAttachment *busA = VirtualBusAttachment::Create(
+                "9a8c3b1e-0d4f-4e0a-9c1b-5f2e7d6a4b3c", "piid-a", true);
+        ASSERT_TRUE(busA != NULL);
+        std::string busNameA = busA->GetUniqueName().c_str();
+        ASSERT_FALSE(busNameA.empty());
+        registry.AddPresence("a", new TestPresence("a"));
+        registry.AddDevice("a", new VirtualDevice(NULL, ":a.1", 1));
+        registry.AddBus("a", busA);
+
+        VirtualBusAttachment *busB = VirtualBusAttachment::Create(
+                "1f2e3d4c-5b6a-4978-8695-a4b3c2d1e0f9", "piid-b", true);
+        ASSERT_TRUE(busB != NULL);
+        std::string busNameB = busB->GetUniqueName().c_str();
+        registry.AddDevice("b", new VirtualDevice(NULL, ":b.1", 2));
+        registry.AddBus("b", busB);
+
+        Registry::Entry *a = registry.Find("a");
+        ASSERT_TRUE(a != NULL);
+        EXPECT_EQ("a", a->m_id);
+        EXPECT_EQ(busA, a->m_bus);
+        EXPECT_EQ(a, registry.FindBySessionId(1));
+        EXPECT_EQ(a, registry.FindByPiid("piid-a"));
+        EXPECT_EQ(a, registry.FindByBusName(busNameA));
+        Registry::Entry *b = registry.Find("b");
+        ASSERT_TRUE(b != NULL);
+        EXPECT_EQ(b, registry.FindBySessionId(2));
+        EXPECT_EQ(b, registry.FindByPiid("piid-b"));
+        EXPECT_EQ(b, registry.FindByBusName(busNameB));
+
+        registry.Destroy("a");
+        EXPECT_TRUE(registry.Find("a") == NULL);
+        EXPECT_TRUE(registry.FindBySessionId(1) == NULL);
+        EXPECT_TRUE(registry.FindByPiid("piid-a") == NULL);
+        EXPECT_TRUE(registry.FindByBusName(busNameA) == NULL);
+        EXPECT_EQ(b, registry.Find("b"));
+        EXPECT_EQ(b, registry.FindBySessionId(2));
+        EXPECT_EQ(b, registry.FindByPiid("piid-b"));
+        EXPECT_EQ(b, registry.FindByBusName(busNameB));
+
+        registry.Destroy("b");
+        EXPECT_TRUE(registry.Begin() == registry.End());
+        EXPECT_TRUE(registry.FindBySessionId(2) == NULL);
+        EXPECT_TRUE(registry.FindByPiid("piid-b") == NULL);
+        EXPECT_TRUE(registry.FindByBusName(busNameB) == NULL);
+    }
+    AllJoynRouterShutdown();
+    AllJoynShutdown();
+}
+
+TEST(RegistryTest, AddReplacesIndexEntries)
+{
+    Registry registry;
+    registry.AddDevice("a", new VirtualDevice(NULL, ":a.1", 1));
+    registry.AddDevice("a", new VirtualDevice(NULL, ":a.2", 2));
+    Registry::Entry *a = registry.Find("a");
+    ASSERT_TRUE(a != NULL);
+    EXPECT_EQ(2u, a->m_device->GetSessionId());
+    EXPECT_TRUE(registry.FindBySessionId(1) == NULL);
+    EXPECT_EQ(a, registry.FindBySessionId(2));
+
+    registry.AddPresence("a", new TestPresence("a"));
+    registry.AddPresence("a", new TestPresence("a"));
+    EXPECT_EQ(a, registry.Find("a"));
+
+    registry.Destroy("a");
+    EXPECT_TRUE(registry.Find("a") == NULL);
+    EXPECT_TRUE(registry.FindBySessionId(2) == NULL);
+    registry.Destroy("a");
+}